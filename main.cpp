@@ -3,46 +3,10 @@
 #include <tuple>
 #include <vector>
 
-static bool win{0};
-
-void PrintMap(int height, std::tuple<int, int> player, std::tuple<int, int> exit, std::vector<std::tuple<int, int>> obstacles)
-{
-    int Px {std::get<0>(player)};
-    int Py {std::get<1>(player)};
-
-    int Ex {std::get<0>(exit)};
-    int Ey {std::get<1>(exit)};
-
-    
-    std::string edge(height, '#');
-    std::string row_template = edge;
-    
-    row_template.replace(row_template.begin()+1, row_template.end()-1, std::string (height-2, '-'));
+#include "maze.h"
+#include "maze_solver.h"
 
-    std::cout << edge << '\n';
-    for (int i = 1; i <= height-1; i++)
-    {
-        std::string row = row_template;
-        if (Ex == i)
-        {
-            row.replace(Ey, 1, "E");
-        }
-        if (Px == i)
-        {
-            row.replace(Py, 1, "P");
-        }
-        for(auto [x,y] : obstacles)
-        {
-            if (x == i)
-            {
-                row.replace(y, 1, "^");
-            }
-        }
-        std::cout << row << '\n';
-        
-    }
-    std::cout << edge << '\n';
-}
+static bool win{0};
 
 std::tuple<int, int> MovePlayer(std::tuple<int, int> player)
 {
@@ -69,12 +33,12 @@ std::tuple<int, int> MovePlayer(std::tuple<int, int> player)
     return player;
 }
 
-std::tuple<int, int> CheckBounds(std::tuple<int, int> player, int height)
+std::tuple<int, int> CheckBounds(std::tuple<int, int> player, const MazeGrid& grid)
 {
-    if (std::get<0>(player) > height-1){
+    if (std::get<0>(player) > grid.rows()-2){
             std::get<0>(player)--;
     }
-    if (std::get<1>(player) > height-2){
+    if (std::get<1>(player) > grid.cols()-2){
         std::get<1>(player)--;
     }
     if (std::get<0>(player) < 1){
@@ -88,22 +52,20 @@ std::tuple<int, int> CheckBounds(std::tuple<int, int> player, int height)
 
 
 
-void Gameloop(bool win)
+void Gameloop(bool win, const MazeGrid& grid)
 {
-    static int height {8};
-
     std::tuple<int, int> player {1,1};
-    std::tuple<int, int> exit {height-1,height-2};
-    std::vector<std::tuple<int, int>> obstacles {{2,3}, {2,2}, {3,1}, {4, 4}, {4, 3}};
+    std::tuple<int, int> exit {grid.rows()-2,grid.cols()-2};
+    MazeView view {grid};
 
     while(!win)
     {
-        PrintMap(height, player, exit, obstacles);
+        view.draw(std::get<0>(player), std::get<1>(player), std::get<0>(exit), std::get<1>(exit));
 
         
 
         player = MovePlayer(player);
-        player = CheckBounds(player, height);
+        player = CheckBounds(player, grid);
 
         int Px = std::get<0>(player);
         int Py = std::get<1>(player);
@@ -111,19 +73,16 @@ void Gameloop(bool win)
         int Ex = std::get<0>(exit);
         int Ey = std::get<1>(exit);
         
-        for(auto [x,y] : obstacles)
+        if (grid.isBlocked(Px, Py))
         {
-            if (x == Px && y == Py)
-            {
-                PrintMap(height, player, exit, obstacles);
-                std::cout << "You lose !";
-                win = true;
-            }
+            view.draw(std::get<0>(player), std::get<1>(player), std::get<0>(exit), std::get<1>(exit));
+            std::cout << "You lose !";
+            win = true;
         }
 
         if (Px == Ex && Py == Ey)
         {
-            PrintMap(height, player, exit, obstacles);
+            view.draw(std::get<0>(player), std::get<1>(player), std::get<0>(exit), std::get<1>(exit));
             std::cout << "You Win !";
             win = true;
         }
@@ -131,8 +90,28 @@ void Gameloop(bool win)
     }
 }
 
-int main()
+int main(int argc, char* argv[])
 {
-    Gameloop(win);
+    try
+    {
+        // The map is height+1 rows of height cells: edge, height-1 rows, edge.
+        MazeOptions options = parseMazeOptions(argc, argv);
+        MazeGrid grid = makeMaze(options, options.size+1, options.size);
+        if (!options.savePath.empty())
+        {
+            grid.save(options.savePath);
+            return 0;
+        }
+        if (!options.solveWith.empty())
+            return solveMaze(grid, options.solveWith);
+        Gameloop(win, grid);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        std::cerr << "Usage: maze [--size N] [--obstacles N [--seed S]] [--map FILE] [--save FILE]\n"
+                     "            [--solve [bfs|astar|bits]]\n";
+        return 1;
+    }
     return 0;
 }
\ No newline at end of file
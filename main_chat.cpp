@@ -2,6 +2,9 @@
 #include <string>
 #include <vector>
 
+#include "maze.h"
+#include "maze_solver.h"
+
 struct Pos
 {
     int x{};
@@ -13,42 +16,6 @@ struct Pos
     }
 };
 
-void printMap(int size, const Pos& player, const Pos& exitPos, const std::vector<Pos>& obstacles)
-{
-    const std::string edge(static_cast<std::size_t>(size), '#');
-
-    // Interior template: "#------#"
-    std::string rowTemplate = edge;
-    rowTemplate.replace(rowTemplate.begin() + 1, rowTemplate.end() - 1, std::string(static_cast<std::size_t>(size - 2), '-'));
-
-    std::cout << edge << '\n';
-
-    // Interior rows: 1 .. size-2
-    for (int x = 1; x < size - 1; ++x)
-    {
-        std::string row = rowTemplate;
-
-        // Place exit first, then player (player drawn "on top" if same cell)
-        if (exitPos.x == x)
-            row[static_cast<std::size_t>(exitPos.y)] = 'E';
-
-        if (player.x == x)
-            row[static_cast<std::size_t>(player.y)] = 'P';
-
-        // Draw obstacles last (matches your original behavior)
-        for (const auto& o : obstacles)
-        {
-            if (o.x == x)
-                row[static_cast<std::size_t>(o.y)] = '^';
-        }
-
-        std::cout << row << '\n';
-    }
-
-    
-    std::cout << edge << '\n';
-}
-
 Pos movePlayer(Pos player)
 {
     char input{};
@@ -67,68 +34,76 @@ Pos movePlayer(Pos player)
     return player;
 }
 
-Pos clampToBounds(Pos player, int size)
+Pos clampToBounds(Pos player, const MazeGrid& grid)
 {
     // Valid interior coordinates are:
-    // x in [1, size-2], y in [1, size-2]
+    // x in [1, rows-2], y in [1, cols-2]
     const int min = 1;
-    const int max = size - 2;
 
     if (player.x < min) player.x = min;
-    if (player.x > max) player.x = max;
+    if (player.x > grid.rows() - 2) player.x = grid.rows() - 2;
     if (player.y < min) player.y = min;
-    if (player.y > max) player.y = max;
+    if (player.y > grid.cols() - 2) player.y = grid.cols() - 2;
 
     return player;
 }
 
-bool isObstacle(const Pos& p, const std::vector<Pos>& obstacles)
+bool isObstacle(const Pos& p, const MazeGrid& grid)
 {
-    for (const auto& o : obstacles)
-    {
-        if (o == p)
-            return true;
-    }
-    return false;
+    return grid.isBlocked(p.x, p.y);
 }
 
-void gameLoop()
+void gameLoop(const MazeGrid& grid)
 {
-    const int size{8}; // adjust maze size here
-
     Pos player{1, 1};
-    const Pos exitPos{size - 2, size - 2}; // bottom-right interior cell
-
-    const std::vector<Pos> obstacles{
-        {2, 3}, {2, 2}, {3, 1}, {4, 4}, {4, 3}
-    };
+    const Pos exitPos{grid.rows() - 2, grid.cols() - 2}; // bottom-right interior cell
+    MazeView view{grid};
 
     bool done{false};
 
     while (!done)
     {
-        printMap(size, player, exitPos, obstacles);
+        view.draw(player.x, player.y, exitPos.x, exitPos.y);
 
         player = movePlayer(player);
-        player = clampToBounds(player, size);
+        player = clampToBounds(player, grid);
 
-        if (isObstacle(player, obstacles))
+        if (isObstacle(player, grid))
         {
-            printMap(size, player, exitPos, obstacles);
+            view.draw(player.x, player.y, exitPos.x, exitPos.y);
             std::cout << "You lose !";
             done = true;
         }
         else if (player == exitPos)
         {
-            printMap(size, player, exitPos, obstacles);
+            view.draw(player.x, player.y, exitPos.x, exitPos.y);
             std::cout << "You Win !";
             done = true;
         }
     }
 }
 
-int main()
+int main(int argc, char* argv[])
 {
-    gameLoop();
+    try
+    {
+        const MazeOptions options = parseMazeOptions(argc, argv);
+        const MazeGrid grid = makeMaze(options, options.size, options.size);
+        if (!options.savePath.empty())
+        {
+            grid.save(options.savePath);
+            return 0;
+        }
+        if (!options.solveWith.empty())
+            return solveMaze(grid, options.solveWith);
+        gameLoop(grid);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        std::cerr << "Usage: maze [--size N] [--obstacles N [--seed S]] [--map FILE] [--save FILE]\n"
+                     "            [--solve [bfs|astar|bits]]\n";
+        return 1;
+    }
     return 0;
 }
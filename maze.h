@@ -0,0 +1,410 @@
+// Maze state shared by the console games (main.cpp, main_chat.cpp): a rows x cols
+// map with one bit per cell (1 = blocked), so a collision test is a single load
+// however many obstacles there are. The outer frame is blocked too; the games
+// clamp moves to the interior [1, rows-2] x [1, cols-2] before testing.
+// Maps can be saved and loaded back; a loaded map is mmapped, not read.
+// MazeView draws them, a terminal-sized window at a time.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MazeGrid
+{
+public:
+    MazeGrid(int rows, int cols)
+        : rows_{rows}, cols_{cols}, wordsPerRow_{(static_cast<std::size_t>(cols) + 63) / 64}
+    {
+        if (rows < 3 || cols < 3)
+            throw std::invalid_argument("a maze needs at least 3 x 3 cells");
+        owned_.assign(static_cast<std::size_t>(rows) * wordsPerRow_, 0);
+        words_ = owned_.data();
+
+        for (int y = 0; y < cols; ++y)
+        {
+            setBlocked(0, y);
+            setBlocked(rows - 1, y);
+        }
+        for (int x = 1; x < rows - 1; ++x)
+        {
+            setBlocked(x, 0);
+            setBlocked(x, cols - 1);
+        }
+    }
+
+    // Maps the file privately: cells changed afterwards stay in this process.
+    static MazeGrid load(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path);
+
+        struct stat st{};
+        Header header{};
+        if (::fstat(fd, &st) < 0 || ::pread(fd, &header, sizeof header, 0) != static_cast<ssize_t>(sizeof header) ||
+            std::memcmp(header.magic, magic, sizeof header.magic) != 0 || header.rows < 3 || header.cols < 3)
+        {
+            ::close(fd);
+            throw std::runtime_error(path + " is not a maze file");
+        }
+
+        MazeGrid grid;
+        grid.rows_ = header.rows;
+        grid.cols_ = header.cols;
+        grid.wordsPerRow_ = (static_cast<std::size_t>(header.cols) + 63) / 64;
+        grid.mapSize_ = sizeof(Header) + static_cast<std::size_t>(header.rows) * grid.wordsPerRow_ * 8;
+        if (static_cast<std::size_t>(st.st_size) != grid.mapSize_)
+        {
+            ::close(fd);
+            throw std::runtime_error(path + " is truncated");
+        }
+
+        grid.map_ = ::mmap(nullptr, grid.mapSize_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (grid.map_ == MAP_FAILED)
+        {
+            grid.map_ = nullptr;
+            throw std::runtime_error("cannot map " + path);
+        }
+        grid.words_ = reinterpret_cast<std::uint64_t*>(static_cast<char*>(grid.map_) + sizeof(Header));
+        return grid;
+    }
+
+    void save(const std::string& path) const
+    {
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            throw std::runtime_error("cannot create " + path);
+
+        Header header{};
+        std::memcpy(header.magic, magic, sizeof header.magic);
+        header.rows = rows_;
+        header.cols = cols_;
+        bool ok = ::write(fd, &header, sizeof header) == static_cast<ssize_t>(sizeof header);
+
+        const char* data = reinterpret_cast<const char*>(words_);
+        std::size_t left = static_cast<std::size_t>(rows_) * wordsPerRow_ * 8;
+        while (ok && left > 0)
+        {
+            const ssize_t n = ::write(fd, data, left);
+            ok = n > 0;
+            if (ok)
+            {
+                data += n;
+                left -= static_cast<std::size_t>(n);
+            }
+        }
+        if (::close(fd) < 0 || !ok)
+            throw std::runtime_error("cannot write " + path);
+    }
+
+    MazeGrid(MazeGrid&& other) noexcept { *this = std::move(other); }
+
+    MazeGrid& operator=(MazeGrid&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            rows_ = other.rows_;
+            cols_ = other.cols_;
+            wordsPerRow_ = other.wordsPerRow_;
+            owned_ = std::move(other.owned_);
+            words_ = other.map_ ? other.words_ : owned_.data();
+            map_ = std::exchange(other.map_, nullptr);
+            mapSize_ = other.mapSize_;
+            other.words_ = nullptr;
+        }
+        return *this;
+    }
+
+    MazeGrid(const MazeGrid&) = delete;
+    MazeGrid& operator=(const MazeGrid&) = delete;
+
+    ~MazeGrid() { unmap(); }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+    bool isBlocked(int x, int y) const
+    {
+        return (rowWords(x)[y >> 6] >> (y & 63)) & 1;
+    }
+
+    void setBlocked(int x, int y, bool blocked = true)
+    {
+        std::uint64_t& word = words_[static_cast<std::size_t>(x) * wordsPerRow_ + (y >> 6)];
+        const std::uint64_t bit = std::uint64_t{1} << (y & 63);
+        word = blocked ? (word | bit) : (word & ~bit);
+    }
+
+    bool onFrame(int x, int y) const
+    {
+        return x == 0 || y == 0 || x == rows_ - 1 || y == cols_ - 1;
+    }
+
+    // Row x as words: cell y is bit y % 64 of word y / 64; bits past cols are 0.
+    const std::uint64_t* rowWords(int x) const
+    {
+        return words_ + static_cast<std::size_t>(x) * wordsPerRow_;
+    }
+    std::size_t wordsPerRow() const { return wordsPerRow_; }
+
+    // Blocks `count` interior cells drawn at random (repeats land on the same cell).
+    void scatter(std::size_t count, std::uint64_t seed)
+    {
+        std::mt19937_64 rng{seed};
+        std::uniform_int_distribution<int> row(1, rows_ - 2);
+        std::uniform_int_distribution<int> col(1, cols_ - 2);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const int x = row(rng);
+            setBlocked(x, col(rng));
+        }
+    }
+
+private:
+    struct Header
+    {
+        char magic[8];
+        std::int32_t rows;
+        std::int32_t cols;
+    };
+    static constexpr char magic[8] = {'M', 'A', 'Z', 'E', 'G', 'R', 'I', 'D'};
+
+    MazeGrid() = default;
+
+    void unmap()
+    {
+        if (map_)
+            ::munmap(map_, mapSize_);
+        map_ = nullptr;
+    }
+
+    int rows_{};
+    int cols_{};
+    std::size_t wordsPerRow_{};
+    std::vector<std::uint64_t> owned_;
+    std::uint64_t* words_{};
+    void* map_{};
+    std::size_t mapSize_{};
+};
+
+// Draws the part of the map around the player that fits the terminal. Each frame
+// is composed in one buffer allocated up front and goes out in one write. On a
+// terminal, after the first frame only the cells that changed are rewritten (the
+// old and new player cells, through ANSI cursor moves); the whole view is redrawn
+// only when the player nears its edge and it scrolls. Piped output gets whole
+// frames, one after another, as the games always printed them.
+class MazeView
+{
+public:
+    explicit MazeView(const MazeGrid& grid, int fd = STDOUT_FILENO)
+        : grid_{grid}, fd_{fd}, terminal_{::isatty(fd) == 1}
+    {
+        int screenRows{24};
+        int screenCols{80};
+        winsize ws{};
+        if (terminal_ && ::ioctl(fd, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0)
+        {
+            screenRows = ws.ws_row;
+            screenCols = ws.ws_col;
+        }
+        // Two lines stay free under the view for the typed move and its newline.
+        viewRows_ = std::min(grid.rows(), std::max(3, screenRows - 2));
+        viewCols_ = std::min(grid.cols(), std::max(3, screenCols));
+
+        // A whole frame, or a redraw of two cells plus the cursor parking.
+        buffer_.reserve(static_cast<std::size_t>(viewRows_) * (viewCols_ + 1) + 64);
+    }
+
+    void draw(int playerX, int playerY, int exitX, int exitY)
+    {
+        buffer_.clear();
+        exitX_ = exitX;
+        exitY_ = exitY;
+        const bool scrolled = follow(playerX, playerY);
+
+        if (!terminal_ || !drawn_ || scrolled)
+        {
+            if (terminal_)
+                buffer_ += "\x1b[H\x1b[2J";
+            for (int x = top_; x < top_ + viewRows_; ++x)
+            {
+                for (int y = left_; y < left_ + viewCols_; ++y)
+                    buffer_ += cell(x, y, playerX, playerY);
+                buffer_ += '\n';
+            }
+        }
+        else if (playerX != playerX_ || playerY != playerY_)
+        {
+            put(playerX_, playerY_, cell(playerX_, playerY_, playerX, playerY));
+            put(playerX, playerY, cell(playerX, playerY, playerX, playerY));
+        }
+
+        // Park the cursor under the view and clear what the last move echoed.
+        if (terminal_)
+            buffer_ += "\x1b[" + std::to_string(viewRows_ + 1) + ";1H\x1b[J";
+
+        drawn_ = true;
+        playerX_ = playerX;
+        playerY_ = playerY;
+        flush();
+    }
+
+private:
+    char cell(int x, int y, int playerX, int playerY) const
+    {
+        if (grid_.isBlocked(x, y))
+            return grid_.onFrame(x, y) ? '#' : '^';
+        if (x == playerX && y == playerY)
+            return 'P';
+        if (x == exitX_ && y == exitY_)
+            return 'E';
+        return '-';
+    }
+
+    // Cell (x, y) of the view is at screen row x - top + 1, column y - left + 1.
+    void put(int x, int y, char c)
+    {
+        buffer_ += "\x1b[" + std::to_string(x - top_ + 1) + ';' + std::to_string(y - left_ + 1) + 'H';
+        buffer_ += c;
+    }
+
+    // Recentres the view on the player once it comes within a quarter view of an
+    // edge; true when the view moved.
+    bool follow(int playerX, int playerY)
+    {
+        const int top = scrollFor(playerX, top_, viewRows_, grid_.rows());
+        const int left = scrollFor(playerY, left_, viewCols_, grid_.cols());
+        const bool moved = top != top_ || left != left_;
+        top_ = top;
+        left_ = left;
+        return moved;
+    }
+
+    static int scrollFor(int p, int origin, int span, int size)
+    {
+        const int margin = span / 4;
+        if (p >= origin + margin && p < origin + span - margin)
+            return origin;
+        return std::clamp(p - span / 2, 0, size - span);
+    }
+
+    void flush()
+    {
+        const char* data = buffer_.data();
+        std::size_t left = buffer_.size();
+        while (left > 0)
+        {
+            const ssize_t n = ::write(fd_, data, left);
+            if (n <= 0)
+                return;
+            data += n;
+            left -= static_cast<std::size_t>(n);
+        }
+    }
+
+    const MazeGrid& grid_;
+    int fd_;
+    bool terminal_;
+    int viewRows_{};
+    int viewCols_{};
+    int top_{};
+    int left_{};
+    int playerX_{};
+    int playerY_{};
+    int exitX_{};
+    int exitY_{};
+    bool drawn_{false};
+    std::string buffer_;
+};
+
+// Command line shared by the games:
+//   --size N          map size (default 8)
+//   --obstacles N     N obstacles at random instead of the fixed ones
+//   --seed S          seed for --obstacles
+//   --map FILE        play a saved map instead
+//   --save FILE       write the map to FILE and exit
+//   --solve [NAME]    print the shortest path to the exit and exit; NAME is bfs
+//                     (the default), astar or bits, see maze_solver.h
+struct MazeOptions
+{
+    int size{8};
+    long long obstacles{-1};
+    std::uint64_t seed{1};
+    std::string mapPath;
+    std::string savePath;
+    std::string solveWith; // empty: play
+};
+
+inline MazeOptions parseMazeOptions(int argc, char* argv[])
+{
+    MazeOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--solve")
+        {
+            options.solveWith = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : "bfs";
+            continue;
+        }
+        if (i + 1 >= argc)
+            throw std::invalid_argument("unknown option " + arg);
+
+        const std::string value = argv[++i];
+        if (arg == "--size")
+            options.size = std::stoi(value);
+        else if (arg == "--obstacles")
+            options.obstacles = std::stoll(value);
+        else if (arg == "--seed")
+            options.seed = std::stoull(value);
+        else if (arg == "--map")
+            options.mapPath = value;
+        else if (arg == "--save")
+            options.savePath = value;
+        else
+            throw std::invalid_argument("unknown option " + arg);
+    }
+    if (options.size < 3 || options.obstacles < -1)
+        throw std::invalid_argument("--size must be at least 3 and --obstacles at least 0");
+    return options;
+}
+
+// The map the options ask for, rows x cols unless loaded. Without --obstacles the
+// fixed obstacles are placed where they fit. The start (1, 1) and the exit
+// (rows-2, cols-2) are always left open.
+inline MazeGrid makeMaze(const MazeOptions& options, int rows, int cols)
+{
+    MazeGrid grid = options.mapPath.empty() ? MazeGrid(rows, cols) : MazeGrid::load(options.mapPath);
+
+    if (options.obstacles >= 0)
+    {
+        grid.scatter(static_cast<std::size_t>(options.obstacles), options.seed);
+    }
+    else if (options.mapPath.empty())
+    {
+        const int fixed[][2]{{2, 3}, {2, 2}, {3, 1}, {4, 4}, {4, 3}};
+        for (const auto& o : fixed)
+        {
+            if (o[0] < grid.rows() - 1 && o[1] < grid.cols() - 1)
+                grid.setBlocked(o[0], o[1]);
+        }
+    }
+
+    grid.setBlocked(1, 1, false);
+    grid.setBlocked(grid.rows() - 2, grid.cols() - 2, false);
+    return grid;
+}
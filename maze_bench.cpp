@@ -0,0 +1,131 @@
+// maze_bench: times the three MazeSolver searches from (1, 1) to (size-2, size-2)
+// on generated size x size maps (obstacles scattered at random, as --obstacles
+// does) over a size x density matrix, and prints one JSON document. Exits 1 if
+// the searches disagree on the path length or a path is not a legal walk.
+// Build: g++ -O2 -std=c++17 maze_bench.cpp -o maze_bench && ./maze_bench > maze_bench.json
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "maze.h"
+#include "maze_solver.h"
+
+template <class T>
+std::vector<T> parseList(const std::string& text, T (*parse)(const std::string&))
+{
+    std::vector<T> out;
+    std::size_t pos = 0;
+    while (pos <= text.size())
+    {
+        std::size_t comma = text.find(',', pos);
+        if (comma == std::string::npos)
+            comma = text.size();
+        out.push_back(parse(text.substr(pos, comma - pos)));
+        pos = comma + 1;
+    }
+    return out;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Every step moves one cell onto an open cell.
+bool isWalk(const MazeGrid& grid, const MazePath& path)
+{
+    for (std::size_t i = 0; i < path.cells.size(); ++i)
+    {
+        const MazeCell c = path.cells[i];
+        if (grid.isBlocked(c.x, c.y))
+            return false;
+        if (i > 0 && std::abs(c.x - path.cells[i - 1].x) + std::abs(c.y - path.cells[i - 1].y) != 1)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> sizes{1000, 4000, 10000};
+    std::vector<double> densities{0.1, 0.3, 0.4};
+    std::uint64_t seed{1};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        try
+        {
+            if (arg == "--sizes" && i + 1 < argc)
+                sizes = parseList<int>(argv[++i], [](const std::string& s) { return std::stoi(s); });
+            else if (arg == "--densities" && i + 1 < argc)
+                densities = parseList<double>(argv[++i], [](const std::string& s) { return std::stod(s); });
+            else if (arg == "--seed" && i + 1 < argc)
+                seed = std::stoull(argv[++i]);
+            else
+                throw std::invalid_argument(arg);
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "Usage: maze_bench [--sizes 1000,4000,...] [--densities 0.1,0.3,...] [--seed S]\n";
+            return 1;
+        }
+    }
+
+    const struct
+    {
+        const char* name;
+        MazeSearch search;
+    } searches[]{{"bfs", MazeSearch::Bfs}, {"astar", MazeSearch::AStar}, {"bits", MazeSearch::Bits}};
+
+    bool failed{false};
+    bool first{true};
+    std::cout << "{\"runs\": [\n";
+    for (const int size : sizes)
+    {
+        for (const double density : densities)
+        {
+            if (size < 3 || density < 0 || density > 1)
+                continue;
+
+            auto start = std::chrono::steady_clock::now();
+            MazeOptions options;
+            options.obstacles = static_cast<long long>(density * (size - 2.0) * (size - 2.0));
+            options.seed = seed;
+            const MazeGrid grid = makeMaze(options, size, size);
+            const double generateSeconds = secondsSince(start);
+
+            std::cout << (first ? "" : ",\n") << "    {\"size\": " << size << ", \"density\": " << density
+                      << ", \"obstacles\": " << options.obstacles << ", \"generate_seconds\": " << generateSeconds
+                      << ",\n     \"searches\": [";
+            first = false;
+
+            MazeSolver solver{grid};
+            int length{};
+            for (const auto& s : searches)
+            {
+                start = std::chrono::steady_clock::now();
+                const MazePath path = solver.solve(s.search, {1, 1}, {size - 2, size - 2});
+                const double seconds = secondsSince(start);
+
+                std::cout << (s.search == MazeSearch::Bfs ? "" : ", ") << "{\"solver\": \"" << s.name
+                          << "\", \"seconds\": " << seconds << ", \"length\": " << path.length()
+                          << ", \"expanded\": " << path.expanded << "}";
+
+                if (s.search == MazeSearch::Bfs)
+                    length = path.length();
+                if (path.length() != length || !isWalk(grid, path))
+                {
+                    std::cerr << "size=" << size << " density=" << density << ": " << s.name << " path of length "
+                              << path.length() << " is not a walk or does not match bfs (" << length << ")\n";
+                    failed = true;
+                }
+            }
+            std::cout << "]}" << std::flush;
+        }
+    }
+    std::cout << "\n]}\n";
+    return failed ? 1 : 0;
+}
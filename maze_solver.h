@@ -0,0 +1,304 @@
+// Shortest path through a MazeGrid from one open cell to another, moving up,
+// down, left or right, three ways:
+//   bfs    breadth-first, a cell at a time
+//   astar  A* with the Manhattan distance to the goal, which on a mostly open map
+//          takes far fewer cells off the frontier
+//   bits   breadth-first a 64-cell word at a time: each frontier word moves into
+//          its neighbours with a few shifts and masks against the grid's own bits
+// All three find a shortest path; they may pick different ones of equal length.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "maze.h"
+
+enum class MazeSearch
+{
+    Bfs,
+    AStar,
+    Bits,
+};
+
+inline MazeSearch mazeSearchNamed(const std::string& name)
+{
+    if (name == "bfs")
+        return MazeSearch::Bfs;
+    if (name == "astar")
+        return MazeSearch::AStar;
+    if (name == "bits")
+        return MazeSearch::Bits;
+    throw std::invalid_argument("unknown solver " + name + " (bfs, astar or bits)");
+}
+
+struct MazeCell
+{
+    int x{};
+    int y{};
+};
+
+struct MazePath
+{
+    bool found{false};
+    std::vector<MazeCell> cells; // start .. goal
+    std::size_t expanded{};      // cells (words for bits) taken off the frontier
+
+    int length() const { return found ? static_cast<int>(cells.size()) - 1 : -1; }
+};
+
+// Keeps its per-cell marks between solves, so one solver serves many queries on
+// the same grid without reallocating.
+class MazeSolver
+{
+public:
+    explicit MazeSolver(const MazeGrid& grid)
+        : grid_{grid}, wordsPerRow_{grid.wordsPerRow()}
+    {
+        const std::size_t words = static_cast<std::size_t>(grid.rows()) * wordsPerRow_;
+        marks_.resize(words);
+    }
+
+    MazePath solve(MazeSearch search, MazeCell start, MazeCell goal)
+    {
+        for (const MazeCell& c : {start, goal})
+        {
+            if (c.x < 0 || c.y < 0 || c.x >= grid_.rows() || c.y >= grid_.cols() || grid_.isBlocked(c.x, c.y))
+                throw std::invalid_argument("start and goal must be open cells of the maze");
+        }
+        std::fill(marks_.begin(), marks_.end(), Marks{});
+
+        MazePath path;
+        switch (search)
+        {
+        case MazeSearch::Bfs: path.expanded = bfs(start, goal); break;
+        case MazeSearch::AStar: path.expanded = astar(start, goal); break;
+        case MazeSearch::Bits: path.expanded = bits(start, goal); break;
+        }
+
+        path.found = isReached(goal.x, goal.y);
+        if (path.found)
+            path.cells = walkBack(start, goal);
+        return path;
+    }
+
+private:
+    // Where a reached cell was entered from, two bits over Marks::fromLow / fromHigh.
+    enum From
+    {
+        Above = 0, // (x-1, y)
+        Below = 1, // (x+1, y)
+        Left = 2,  // (x, y-1)
+        Right = 3, // (x, y+1)
+    };
+
+    std::size_t wordOf(int x, int y) const { return static_cast<std::size_t>(x) * wordsPerRow_ + (y >> 6); }
+
+    bool isReached(int x, int y) const { return (marks_[wordOf(x, y)].reached >> (y & 63)) & 1; }
+
+    void mark(std::size_t word, std::uint64_t bits, int from)
+    {
+        marks_[word].reached |= bits;
+        if (from & 1)
+            marks_[word].fromLow |= bits;
+        if (from & 2)
+            marks_[word].fromHigh |= bits;
+    }
+
+    bool open(int x, int y) const { return !grid_.isBlocked(x, y) && !isReached(x, y); }
+
+    std::size_t bfs(MazeCell start, MazeCell goal)
+    {
+        std::vector<MazeCell> level{start};
+        std::vector<MazeCell> next;
+        mark(wordOf(start.x, start.y), std::uint64_t{1} << (start.y & 63), Above);
+
+        std::size_t expanded{};
+        while (!level.empty() && !isReached(goal.x, goal.y))
+        {
+            next.clear();
+            for (const MazeCell& c : level)
+            {
+                ++expanded;
+                // The frame is blocked, so an open cell's neighbours are all on the map.
+                const MazeCell steps[]{{c.x + 1, c.y}, {c.x - 1, c.y}, {c.x, c.y + 1}, {c.x, c.y - 1}};
+                const int from[]{Above, Below, Left, Right};
+                for (int i = 0; i < 4; ++i)
+                {
+                    const MazeCell n = steps[i];
+                    if (!open(n.x, n.y))
+                        continue;
+                    mark(wordOf(n.x, n.y), std::uint64_t{1} << (n.y & 63), from[i]);
+                    next.push_back(n);
+                }
+            }
+            level.swap(next);
+        }
+        return expanded;
+    }
+
+    // Lazy A*: a cell may sit in the queue more than once and counts as reached
+    // (with the move that got there) when first taken off it. The Manhattan
+    // distance never overestimates, so that first time is along a shortest path.
+    std::size_t astar(MazeCell start, MazeCell goal)
+    {
+        struct Entry
+        {
+            int f;
+            int g;
+            MazeCell cell;
+            int from;
+        };
+        // Lowest f first; among equal f the deepest, which heads straight for the goal.
+        auto later = [](const Entry& a, const Entry& b) { return a.f != b.f ? a.f > b.f : a.g < b.g; };
+        std::priority_queue<Entry, std::vector<Entry>, decltype(later)> queue(later);
+        auto h = [&goal](int x, int y) { return std::abs(x - goal.x) + std::abs(y - goal.y); };
+
+        queue.push({h(start.x, start.y), 0, start, Above});
+        std::size_t expanded{};
+        while (!queue.empty())
+        {
+            const Entry e = queue.top();
+            queue.pop();
+            const MazeCell c = e.cell;
+            if (isReached(c.x, c.y))
+                continue;
+            mark(wordOf(c.x, c.y), std::uint64_t{1} << (c.y & 63), e.from);
+            ++expanded;
+            if (c.x == goal.x && c.y == goal.y)
+                break;
+
+            const MazeCell steps[]{{c.x + 1, c.y}, {c.x - 1, c.y}, {c.x, c.y + 1}, {c.x, c.y - 1}};
+            const int from[]{Above, Below, Left, Right};
+            for (int i = 0; i < 4; ++i)
+            {
+                const MazeCell n = steps[i];
+                if (open(n.x, n.y))
+                    queue.push({e.g + 1 + h(n.x, n.y), e.g + 1, n, from[i]});
+            }
+        }
+        return expanded;
+    }
+
+    // Each level keeps the frontier as a list of words with their newly reached
+    // bits (a word may be listed once per neighbour that reached into it). A word
+    // moves into itself shifted by one cell each way, carrying across the word
+    // edges, and into the same word of the rows above and below.
+    std::size_t bits(MazeCell start, MazeCell goal)
+    {
+        struct Step
+        {
+            std::size_t word;
+            std::uint64_t bits;
+        };
+        const std::uint64_t* blocked = grid_.rowWords(0);
+        std::vector<Step> level;
+        std::vector<Step> next;
+
+        auto enter = [&](std::size_t word, std::uint64_t cells, int from) {
+            cells &= ~blocked[word] & ~marks_[word].reached;
+            if (!cells)
+                return;
+            mark(word, cells, from);
+            next.push_back({word, cells});
+        };
+
+        const std::size_t startWord = wordOf(start.x, start.y);
+        mark(startWord, std::uint64_t{1} << (start.y & 63), Above);
+        level.push_back({startWord, std::uint64_t{1} << (start.y & 63)});
+
+        std::size_t expanded{};
+        while (!level.empty() && !isReached(goal.x, goal.y))
+        {
+            for (const Step& step : level)
+            {
+                const std::size_t word = step.word;
+                const std::uint64_t f = step.bits;
+                ++expanded;
+                // Both shifts at once; a cell reachable both ways is entered from the right.
+                const std::uint64_t sideways = ((f << 1) | (f >> 1)) & ~blocked[word] & ~marks_[word].reached;
+                if (sideways)
+                {
+                    marks_[word].reached |= sideways;
+                    marks_[word].fromHigh |= sideways;
+                    marks_[word].fromLow |= sideways & (f >> 1);
+                    next.push_back({word, sideways});
+                }
+                // Frontier cells are open, hence off the frame: none of these leave the map.
+                if (f >> 63)
+                    enter(word + 1, f >> 63, Left);
+                if (f & 1)
+                    enter(word - 1, f << 63, Right);
+                enter(word - wordsPerRow_, f, Below);
+                enter(word + wordsPerRow_, f, Above);
+            }
+            level.swap(next);
+            next.clear();
+        }
+        return expanded;
+    }
+
+    std::vector<MazeCell> walkBack(MazeCell start, MazeCell goal) const
+    {
+        std::vector<MazeCell> cells{goal};
+        MazeCell c = goal;
+        while (c.x != start.x || c.y != start.y)
+        {
+            const std::size_t word = wordOf(c.x, c.y);
+            const int from = static_cast<int>(((marks_[word].fromLow >> (c.y & 63)) & 1) |
+                                              (((marks_[word].fromHigh >> (c.y & 63)) & 1) << 1));
+            switch (from)
+            {
+            case Above: --c.x; break;
+            case Below: ++c.x; break;
+            case Left: --c.y; break;
+            case Right: ++c.y; break;
+            }
+            cells.push_back(c);
+        }
+        return {cells.rbegin(), cells.rend()};
+    }
+
+    const MazeGrid& grid_;
+    std::size_t wordsPerRow_;
+    // A word's three marks side by side, so a visit touches one place in memory, not three.
+    struct Marks
+    {
+        std::uint64_t reached;
+        std::uint64_t fromLow;
+        std::uint64_t fromHigh;
+    };
+    std::vector<Marks> marks_;
+};
+
+// --solve: the path from the start (1, 1) to the exit (rows-2, cols-2) instead of
+// a game. Returns the exit status, 2 when the exit cannot be reached.
+inline int solveMaze(const MazeGrid& grid, const std::string& solverName)
+{
+    const MazeSearch search = mazeSearchNamed(solverName);
+    MazeSolver solver{grid};
+
+    const auto start = std::chrono::steady_clock::now();
+    const MazePath path = solver.solve(search, {1, 1}, {grid.rows() - 2, grid.cols() - 2});
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << solverName << ": " << elapsed.count() << " ms, " << path.expanded << " expanded\n";
+    if (!path.found)
+    {
+        std::cout << "No path to the exit\n";
+        return 2;
+    }
+    std::cout << "Path length: " << path.length() << '\n';
+    std::cout << "Path:";
+    for (const MazeCell& c : path.cells)
+        std::cout << " (" << c.x << ',' << c.y << ')';
+    std::cout << '\n';
+    return 0;
+}
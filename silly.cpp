@@ -1,7 +1,17 @@
 /*
-// Build+search the most syllable-efficient spoken form for a number (computed fresh each run).
-// Compile: g++ -O2 -pthread silly.cpp -o silly
+// Build+search the most syllable-efficient spoken form for a number.
+// Compile: g++ -O2 -pthread silly.cpp -o silly   (add -mavx2 for the vector "+"/"-" kernel)
+// Bench:   g++ -O2 -pthread -DSILLY_BENCH silly.cpp -o silly_bench && ./silly_bench > bench.json
+// Check:   ./silly_bench --check 20000 --threads 1,4 (against a reference search), --baseline bench.json (timing,
+//          including the targeted lookups near 1e12; --lookups 0 skips them)
 // Run: ./silly 27 --quiet
+// Large: ./silly 123456789012 (past 2,000,000 only a small dense core is built; the rest is searched on demand)
+// Table: ./silly --build-table 2000000 --table silly.table, then ./silly 27 --table silly.table
+// Grow:  ./silly --build-table 2000000 --table big.table --extend small.table (reuses small.table's search)
+// Shard: ./silly --build-table 8000000 --table big.table --shards 4 (4 processes, one slice of the slots each)
+// Batch: ./silly --batch queries.txt --format jsonl, ./silly --range 1..100000 > names.tsv
+// Top:   ./silly 27 --top 3 (the 3 best distinct forms, ranked; also with --batch and --range)
+// Library: g++ -O2 -pthread -DSILLY_LIBRARY -c silly.cpp -o silly.o, with silly.h (SyllableSolver)
 */
 
 #include <iostream>
@@ -12,6 +22,43 @@
 #include <stdexcept>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <unordered_map>
+#include <map>
+#include <numeric>
+#include <limits>
+#include <functional>
+
+#include "silly.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef SILLY_BENCH
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
 using std::string;
 using std::vector;
@@ -22,28 +69,91 @@ struct OneName { string card; int cardSyl; string ord; int ordSyl; };
 struct TenName { string card; int cardSyl; string ord; int ordSyl; };
 struct LargeName { string word; int syl; int base; int zeroesAdd; };
 
-struct Entry {
-    int value{};
-    vector<int> syllables;
-    vector<string> names;
-    vector<string> equations;
-    int original{};   // base spoken syllables for the plain number
-    int zeroes{};
-    int digits{};
-    int nonzero{};
-    bool auto_pass{};
+enum class DerivKind : uint8_t { Base, Unary, Binary };
+
+// What an op computes; see OpTraits.
+enum class OpKind : uint8_t { Add, Multiply, Subtract, Divide, Fraction, Power, Square, Cube };
+
+// Winning derivation of one (value, pemdas level), decoded from its slot word;
+// names/equations are rebuilt from these.
+struct Derivation {
+    DerivKind kind{DerivKind::Base};
+    uint8_t op{};           // index into unary_ops / binary_ops
+    uint8_t left_level{};
+    uint8_t right_level{};
+    long long left{};
+    long long right{};
+};
+
+// Heap array left uninitialized by reset: the base fill writes every element,
+// so each page is touched once, by the thread that fills it.
+template <class T>
+class FillArray {
+public:
+    void reset(size_t n) {
+        data_.reset();
+        data_.reset(new T[n]);
+        size_ = n;
+    }
+    T* data() { return data_.get(); }
+    const T* data() const { return data_.get(); }
+    size_t size() const { return size_; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+
+private:
+    std::unique_ptr<T[]> data_;
+    size_t size_{};
+};
+
+using Answer = SyllableAnswer;
+
+// Structure-of-arrays table: each per-number field is one contiguous array
+// (per pemdas level where it has one), so scans over n walk memory linearly.
+// `keys` is authoritative while ops run; `syllables` mirrors its top byte and
+// is written only by the thread that lowered the count.
+struct NumberTable {
+    int count{};
+    FillArray<uint8_t> syllables;     // [pemdas_count][count]
+    FillArray<std::atomic<uint64_t>> keys;  // [pemdas_count][count], see make_key
+    FillArray<uint8_t> original;      // base spoken syllables for the plain number
+    FillArray<uint8_t> zeroes;
+    FillArray<uint8_t> digits;
+    FillArray<uint8_t> nonzero;
+    FillArray<uint8_t> auto_pass;
+
+    // Sizes the arrays for [0, max_number]; contents are undefined until filled.
+    void reset(int max_number) {
+        count = max_number + 1;
+        syllables.reset((size_t)pemdas_count * count);
+        keys.reset((size_t)pemdas_count * count);
+        original.reset(count);
+        zeroes.reset(count);
+        digits.reset(count);
+        nonzero.reset(count);
+        auto_pass.reset(count);
+    }
+
+    uint8_t* syl(int u) { return syllables.data() + (size_t)u * count; }
+    const uint8_t* syl(int u) const { return syllables.data() + (size_t)u * count; }
+    std::atomic<uint64_t>* key(int u) { return keys.data() + (size_t)u * count; }
+    const std::atomic<uint64_t>* key(int u) const { return keys.data() + (size_t)u * count; }
+    const uint64_t* raw_keys() const { return reinterpret_cast<const uint64_t*>(keys.data()); }
+
+    Answer lookup(long long n) const;
+    // The same with top_key (one of n's --top words) in place of n's own top-level word.
+    Answer lookup(long long n, uint64_t top_key) const;
 };
 
 struct BaseOut {
     int n_syl;
-    string n_name;
     int frac_syl;
-    string frac_name;
     int zeroes;
     int digits;
 };
 
 struct UnaryOp {
+    OpKind kind;
     string id;
     int syllables;
     string text;
@@ -53,6 +163,7 @@ struct UnaryOp {
 };
 
 struct BinaryOp {
+    OpKind kind;
     string id;
     int syllables;
     string text;
@@ -62,8 +173,6 @@ struct BinaryOp {
     int pemdas_result;
 };
 
-static vector<Entry> number_names;
-
 // Data tables
 static const vector<OneName> one_names = {
     {"zero",2,"zeroeth",2},
@@ -108,6 +217,21 @@ static const vector<LargeName> large_names = {
     {"billion", 2, 1000000000,9},
 };
 
+static const vector<UnaryOp> unary_ops = {
+    {OpKind::Square, "²", 1, " squared", 2, 2, 2},
+    {OpKind::Cube,   "³", 1, " cubed",   3, 2, 2},
+};
+
+static const vector<BinaryOp> binary_ops = {
+    {OpKind::Add,      "+", 1, " plus ",  "", 5, 5, 5},
+    {OpKind::Multiply, "*", 1, " times ", "", 3, 4, 4},
+    {OpKind::Multiply, "*", 1, " times ", "", 3, 3, 3},
+    {OpKind::Subtract, "-", 2, " minus ", "", 5, 4, 5},
+    {OpKind::Divide,   "/", 2, " over ",  "", 3, 2, 4},
+    {OpKind::Fraction, "fraction", 0, " ", "s", 2, 0, 2},
+    {OpKind::Power,    "^", 2, " to the ", "", 2, 0, 2},
+};
+
 // exponent formatting
 static const vector<string> superscripts = {
     "⁰","¹","²","³","⁴","⁵","⁶","⁷","⁸","⁹",
@@ -115,504 +239,3382 @@ static const vector<string> superscripts = {
     "²⁰","²¹","²²","²³"
 };
 
-// -------- small parallel helpers --------
-static int default_threads() {
-    unsigned hc = std::thread::hardware_concurrency();
-    return (hc == 0 ? 4 : (int)hc);
-}
-
-template <class Func>
-static void parallel_for_chunks(int start, int end, int threads, Func fn) {
-    if (end <= start) return;
-    if (threads <= 1) {
-        fn(start, end);
-        return;
-    }
+// -------- op kernels --------
+// Everything the search does with one op lives in its OpTraits specialization:
+// how a split's pairs are enumerated, operand bounds, the output, and the right
+// operand recovered from (output, left) on decode. The pair loops are
+// instantiated per kind through with_binary_op / with_unary_op, so none of this
+// is dispatched per pair. A new op is an OpKind, a row in binary_ops or
+// unary_ops, and a specialization here.
+enum class Pairing : uint8_t {
+    Sumset,     // out = fixed +/- member: the member bitset shifted by the fixed operand
+    Multiples,  // rights in a range, straight from the right bitset
+    Divisors,   // rights among the divisors of left
+    Scan,       // the sorted right list between the bounds
+};
 
-    int total = end - start;
-    int chunk = (total + threads - 1) / threads;
+// Outputs [lo, hi] a fixed Sumset operand reaches; out = member - delta.
+struct SumWindow {
+    long long delta;
+    int lo;
+    int hi;
+};
 
-    vector<std::thread> ts;
-    ts.reserve(threads);
+// A closed interval of operand or output values; outputs(...) bounds every output
+// of operands drawn from the given ranges (values are >= 0).
+struct OutRange {
+    long long lo, hi;
+};
 
-    for (int t = 0; t < threads; ++t) {
-        int b = start + t * chunk;
-        int e = std::min(end, b + chunk);
-        if (b >= e) break;
-        ts.emplace_back([=, &fn]() { fn(b, e); });
+// base^exp, held at LLONG_MAX once it overflows.
+static long long saturating_power(long long base, long long exp) {
+    constexpr long long cap = std::numeric_limits<long long>::max();
+    long long out = 1;
+    for (long long i = 0; i < exp; ++i) {
+        if (base != 0 && out > cap / base) return cap;
+        out *= base;
     }
-    for (auto& th : ts) th.join();
+    return out;
 }
 
-static BaseOut base_syllables(int n) {
-    if (n < 20) {
-        return { one_names[n].cardSyl, one_names[n].card,
-                 one_names[n].ordSyl, one_names[n].ord,
-                 0, 1 };
-    } else if (n < 100) {
-        int n_mod = n % 10;
-        int n_div = n / 10;
+template <OpKind K> struct OpTraits;
+
+// first_extremes bounds the fixed operand (left for "+").
+template <> struct OpTraits<OpKind::Add> {
+    static constexpr Pairing pairing = Pairing::Sumset;
+    static constexpr bool fixed_left = true;
+    static constexpr bool naming_rule = false;
+    static std::pair<double,double> first_extremes(int, int max_number) { return { 6.0, (double)max_number - 1.0 }; }
+    // right in [1, min(v, max - v)]
+    static SumWindow window(int v, int min_missing, int max_number) {
+        return { -(long long)v, std::max(v + 1, min_missing), v + std::min(v, max_number - v) };
+    }
+    static int left_of(int fixed, int) { return fixed; }
+    static long long output(long long left, long long right) { return left + right; }
+    static OutRange outputs(OutRange left, OutRange right) { return { left.lo + right.lo, left.hi + right.hi }; }
+    static long long right_of(long long value, long long left) { return value - left; }
+};
 
-        if (n_mod == 0) {
-            const auto& t = ten_names[n_div];
-            return { t.cardSyl, t.card, t.ordSyl, t.ord, 1, 2 };
-        }
+// The fixed operand of "-" is the right one; left = out + right <= max. It is at
+// least 1: "n - 0" never beats n, and is no other form of it for --top.
+template <> struct OpTraits<OpKind::Subtract> {
+    static constexpr Pairing pairing = Pairing::Sumset;
+    static constexpr bool fixed_left = false;
+    static constexpr bool naming_rule = false;
+    static std::pair<double,double> first_extremes(int, int max_number) { return { 1.0, (double)max_number }; }
+    static SumWindow window(int v, int min_missing, int max_number) { return { v, min_missing, max_number - v }; }
+    static int left_of(int fixed, int out) { return out + fixed; }
+    static long long output(long long left, long long right) { return left - right; }
+    static OutRange outputs(OutRange left, OutRange right) { return { left.lo - right.hi, left.hi - right.lo }; }
+    static long long right_of(long long value, long long left) { return left - value; }
+};
 
-        const auto& mod = number_names[n_mod];
-        const auto& t = ten_names[n_div];
+template <> struct OpTraits<OpKind::Multiply> {
+    static constexpr Pairing pairing = Pairing::Multiples;
+    static constexpr bool naming_rule = false;
+    static std::pair<double,double> first_extremes(int, int max_number) {
+        return { 2.0, std::pow((double)max_number, 0.5) };
+    }
+    static std::pair<double,double> second_extremes(int min_missing, int max_number, int left) {
+        return { (double)std::max(left, (int)std::ceil((double)min_missing / left)), (double)max_number / left };
+    }
+    static long long output(long long left, long long right) { return left * right; }
+    static OutRange outputs(OutRange left, OutRange right) { return { left.lo * right.lo, left.hi * right.hi }; }
+    static long long right_of(long long value, long long left) { return value / left; }
+};
 
-        int syl_card = t.cardSyl + mod.syllables[1];
-        string name_card = t.card + "-" + mod.names[1];
+template <> struct OpTraits<OpKind::Divide> {
+    static constexpr Pairing pairing = Pairing::Divisors;
+    static constexpr bool naming_rule = false;
+    static std::pair<double,double> first_extremes(int min_missing, int max_number) {
+        return { (double)min_missing * 2.0, (double)max_number };
+    }
+    static std::pair<double,double> second_extremes(int, int, int left) { return { 2.0, (double)left / 2.0 }; }
+    static long long output(long long left, long long right) { return left / right; }
+    static OutRange outputs(OutRange left, OutRange right) {
+        return { left.lo / std::max(right.hi, 1LL), left.hi / std::max(right.lo, 1LL) };
+    }
+    static long long right_of(long long value, long long left) { return left / value; }
+};
 
-        int syl_frac = t.cardSyl + mod.syllables[0];
-        string name_frac = t.card + "-" + mod.names[0];
+// "<left> <right>ths": "/" with a different spelling, subject to fraction_rejected.
+template <> struct OpTraits<OpKind::Fraction> : OpTraits<OpKind::Divide> {
+    static constexpr bool naming_rule = true;
+};
 
-        return { syl_card, name_card, syl_frac, name_frac, 0, 2 };
+template <> struct OpTraits<OpKind::Power> {
+    static constexpr Pairing pairing = Pairing::Scan;
+    static constexpr bool naming_rule = false;
+    static std::pair<double,double> first_extremes(int, int max_number) {
+        return { 2.0, std::pow((double)max_number, 0.2) };
+    }
+    // Exponents run from 5 to the last superscript.
+    static std::pair<double,double> second_extremes(int, int max_number, int left) {
+        return { 5.0, std::min(std::log((double)max_number) / std::log((double)left), (double)superscripts.size() - 1) };
+    }
+    static long long output(long long left, long long right) {
+        long long out = 1;
+        for (long long i = 0; i < right; ++i) out *= left;
+        return out;
+    }
+    static OutRange outputs(OutRange left, OutRange right) {
+        return { left.lo <= 1 ? 0 : saturating_power(left.lo, right.lo), saturating_power(left.hi, right.hi) };
     }
+    static long long right_of(long long value, long long left) {
+        long long right = 1;
+        for (long long p = left; p < value; p *= left) ++right;
+        return right;
+    }
+};
 
-    int large_index = 0;
-    while (large_index + 1 < (int)large_names.size() && large_names[large_index + 1].base <= n) {
-        large_index++;
+template <> struct OpTraits<OpKind::Square> {
+    static std::pair<double,double> first_extremes(int min_missing, int max_number) {
+        return { std::pow((double)min_missing, 1.0/2.0), std::pow((double)max_number, 1.0/2.0) };
     }
+    static long long output(long long in) { return in * in; }
+    static OutRange outputs(OutRange in) { return { output(in.lo), output(in.hi) }; }
+};
 
-    const auto& L = large_names[large_index];
-    int n_mod = n % L.base;
-    int n_div = n / L.base;
+template <> struct OpTraits<OpKind::Cube> {
+    static std::pair<double,double> first_extremes(int min_missing, int max_number) {
+        return { std::pow((double)min_missing, 1.0/3.0), std::pow((double)max_number, 1.0/3.0) };
+    }
+    static long long output(long long in) { return in * in * in; }
+    static OutRange outputs(OutRange in) { return { output(in.lo), output(in.hi) }; }
+};
 
-    if (n_mod == 0) {
-        const auto& div = number_names[n_div];
-        return {
-            div.syllables[1] + L.syl,
-            div.names[1] + " " + L.word,
-            div.syllables[1] + L.syl,
-            div.names[1] + " " + L.word + "th",
-            L.zeroesAdd + div.zeroes,
-            L.zeroesAdd + div.digits
-        };
+// fn(std::integral_constant<OpKind, K>{}) for the op's kind.
+template <class Fn>
+static decltype(auto) with_binary_op(OpKind kind, Fn&& fn) {
+    switch (kind) {
+    case OpKind::Add:      return fn(std::integral_constant<OpKind, OpKind::Add>{});
+    case OpKind::Multiply: return fn(std::integral_constant<OpKind, OpKind::Multiply>{});
+    case OpKind::Subtract: return fn(std::integral_constant<OpKind, OpKind::Subtract>{});
+    case OpKind::Divide:   return fn(std::integral_constant<OpKind, OpKind::Divide>{});
+    case OpKind::Fraction: return fn(std::integral_constant<OpKind, OpKind::Fraction>{});
+    case OpKind::Power:    return fn(std::integral_constant<OpKind, OpKind::Power>{});
+    default: break;
     }
+    throw std::logic_error("not a binary op");
+}
 
-    string connect_word = " ";
-    int connect_syll = 0;
+template <class Fn>
+static decltype(auto) with_unary_op(OpKind kind, Fn&& fn) {
+    switch (kind) {
+    case OpKind::Square: return fn(std::integral_constant<OpKind, OpKind::Square>{});
+    case OpKind::Cube:   return fn(std::integral_constant<OpKind, OpKind::Cube>{});
+    default: break;
+    }
+    throw std::logic_error("not a unary op");
+}
 
-    const auto& div = number_names[n_div];
-    const auto& mod = number_names[n_mod];
+// -------- packed slot words --------
+// One 64-bit word per (value, pemdas level): syllables in the top byte, then
+// the inverted tie-break rank, so a smaller word is always the better entry
+// and commits are a compare-and-swap minimum. At equal syllables the candidate
+// the sequential search would have written last wins (later op, then more
+// left syllables, then larger left operand); plain numbers rank lowest.
+// The right operand is implied by (op, value, left) and recovered on decode.
+static constexpr int key_syl_shift = 56;
+static constexpr uint64_t rank_mask = (1ull << key_syl_shift) - 1;
+static constexpr int rank_op_shift = 52;        // 4 bits: 0 = plain, then binary_ops, then unary_ops
+// 8 bits, as wide as the count itself: a left operand is spelled in fewer
+// syllables than the form it is part of, even at 12 digits.
+static constexpr int rank_left_syl_shift = 44;
+static constexpr uint64_t rank_left_mask = (1ull << rank_left_syl_shift) - 1;
+static_assert(SyllableSolver::lookup_max <= (long long)rank_left_mask, "left operands fit below left_syl");
+
+static uint64_t make_key(int syllables, uint64_t rank) {
+    return ((uint64_t)syllables << key_syl_shift) | (rank_mask - rank);
+}
 
-    return {
-        div.syllables[1] + L.syl + connect_syll + mod.syllables[1],
-        div.names[1] + " " + L.word + connect_word + mod.names[1],
-        div.syllables[1] + L.syl + connect_syll + mod.syllables[0],
-        div.names[1] + " " + L.word + connect_word + mod.names[0],
-        mod.zeroes,
-        L.zeroesAdd + div.digits
-    };
+static uint64_t op_rank(int op_order, int left_syl, long long left) {
+    return ((uint64_t)op_order << rank_op_shift) | ((uint64_t)left_syl << rank_left_syl_shift) | (uint64_t)left;
 }
 
-static std::pair<double,double> get_first_extremes(const string& id, int min_missing, int max_number) {
-    if (id == "²") return { std::pow((double)min_missing, 1.0/2.0), std::pow((double)max_number, 1.0/2.0) };
-    if (id == "³") return { std::pow((double)min_missing, 1.0/3.0), std::pow((double)max_number, 1.0/3.0) };
-    if (id == "+") return { 6.0, (double)max_number - 1.0 };
-    if (id == "*") return { 2.0, std::pow((double)max_number, 0.5) };
-    if (id == "-") return { (double)min_missing + 1.0, (double)max_number };
-    if (id == "/" || id == "fraction") return { (double)min_missing * 2.0, (double)max_number };
-    if (id == "^") return { 2.0, std::pow((double)max_number, 0.2) };
-    return {0.0, 0.0};
+static int key_syllables(uint64_t key) { return (int)(key >> key_syl_shift); }
+static bool key_is_plain(uint64_t key) { return (key & rank_mask) == rank_mask; }
+
+static Derivation decode_key(uint64_t key, long long value) {
+    const uint64_t rank = rank_mask - (key & rank_mask);
+    const int order = (int)(rank >> rank_op_shift);
+    const long long left = (long long)(rank & rank_left_mask);
+    if (order == 0) return {};
+
+    if (order > (int)binary_ops.size()) {
+        const int k = order - 1 - (int)binary_ops.size();
+        return { DerivKind::Unary, (uint8_t)k, (uint8_t)unary_ops[k].pemdas_input, 0, left, 0 };
+    }
+
+    const auto& op = binary_ops[order - 1];
+    const long long right = with_binary_op(op.kind, [&](auto kind) {
+        return OpTraits<decltype(kind)::value>::right_of(value, left);
+    });
+    return { DerivKind::Binary, (uint8_t)(order - 1), (uint8_t)op.pemdas_left, (uint8_t)op.pemdas_right,
+             left, right };
 }
 
-static std::pair<double,double> get_second_extremes(const string& id, int min_missing, int max_number, int left_value) {
-    if (id == "+") return { 1.0, (double)std::min(left_value, max_number - left_value) };
-    if (id == "*") return { (double)std::max(left_value, (int)std::ceil((double)min_missing / left_value)), (double)max_number / left_value };
-    if (id == "-") return { 1.0, (double)(left_value - min_missing) };
-    if (id == "/" || id == "fraction") return { 2.0, (double)left_value / 2.0 };
-    if (id == "^") return { 5.0, std::log((double)max_number) / std::log((double)left_value) };
-    return {0.0, 0.0};
+struct Offer {
+    bool replaced;      // key is now in the slot
+    bool lowered;       // ... and the syllable count went down
+    uint32_t retries;   // compare-exchange attempts lost to other threads
+};
+
+// Lower `slot` to `key` if it is better.
+static Offer offer_key(std::atomic<uint64_t>& slot, uint64_t key) {
+    Offer r{};
+    uint64_t cur = slot.load(std::memory_order_relaxed);
+    while (key < cur) {
+        if (slot.compare_exchange_weak(cur, key, std::memory_order_relaxed)) {
+            r.replaced = true;
+            r.lowered = key_syllables(cur) > key_syllables(key);
+            return r;
+        }
+        ++r.retries;
+    }
+    return r;
 }
 
-static std::pair<long long,bool> get_output(const string& id, long long left_value, long long right_value = 0) {
-    if (id == "²") return { left_value * left_value, true };
-    if (id == "³") return { left_value * left_value * left_value, true };
-    if (id == "^") {
-        long long out = 1;
-        for (long long i = 0; i < right_value; ++i) out *= left_value;
-        return { out, true };
+// --top: the k best distinct derivations of every number at the top level, as
+// slot words sorted best first, ~0 for an empty place. Distinct means another
+// phrasing: "*@3" and "*@4" with the same left operand read the same, so only
+// the better of the two is kept. Entry 0 always ends up as the table's own word.
+class AltTable {
+public:
+    static constexpr uint64_t empty = ~0ull;
+    static constexpr int top_limit = 8;   // largest k
+
+    void reset(int count, int k) {
+        k_ = k;
+        words_.reset((size_t)count * k);
+        locks_.reset((size_t)count);
     }
-    if (id == "+") return { left_value + right_value, true };
-    if (id == "*") return { left_value * right_value, true };
-    if (id == "-") return { left_value - right_value, true };
-    if (id == "/" || id == "fraction") {
-        if (right_value != 0 && left_value % right_value == 0) return { left_value / right_value, true };
-        return {0, false};
+    int k() const { return k_; }
+
+    // Starts n's list at its plain word.
+    void start(int n, uint64_t key) {
+        std::atomic<uint64_t>* w = words_.data() + (size_t)n * k_;
+        w[0].store(key, std::memory_order_relaxed);
+        for (int i = 1; i < k_; ++i) w[i].store(empty, std::memory_order_relaxed);
+        locks_[n].store(0, std::memory_order_relaxed);
     }
-    return {0, false};
-}
 
-static void number_names_generator(int leave_point, int max_number, bool show_progress) {
-    number_names.clear();
-    number_names.reserve(max_number + 1);
+    // Worst word still in n's list; nothing at or above it gets in.
+    uint64_t last(int n) const { return words_[(size_t)n * k_ + k_ - 1].load(std::memory_order_relaxed); }
+    uint64_t word(long long n, int i) const { return words_[(size_t)n * k_ + i].load(std::memory_order_relaxed); }
 
-    int max_syllables = 0;
+    void offer(int n, uint64_t key) {
+        if (key >= last(n)) return;
+        std::atomic<uint64_t>* w = words_.data() + (size_t)n * k_;
+        while (locks_[n].exchange(1, std::memory_order_acquire)) {
+        }
+        uint64_t list[top_limit];
+        int size = 0, same = -1;
+        for (int i = 0; i < k_; ++i) {
+            const uint64_t v = w[i].load(std::memory_order_relaxed);
+            if (v == empty) break;
+            if (same_phrasing(v, key)) same = size;
+            list[size++] = v;
+        }
+        // A same-phrasing entry that is at least as good keeps the place; a worse one gives it up.
+        bool in = same < 0 || key < list[same];
+        if (in && same >= 0) {
+            std::copy(list + same + 1, list + size, list + same);
+            --size;
+        }
+        in = in && (size < k_ || key < list[size - 1]);
+        if (in) {
+            int at = std::min(size, k_ - 1);
+            while (at > 0 && list[at - 1] > key) {
+                list[at] = list[at - 1];
+                --at;
+            }
+            list[at] = key;
+            size = std::min(size + 1, k_);
+        }
+        for (int i = 0; i < k_; ++i) w[i].store(i < size ? list[i] : empty, std::memory_order_relaxed);
+        locks_[n].store(0, std::memory_order_release);
+    }
 
-    // Base fill (kept sequential because base_syllables reads earlier number_names)
-    for (int n = 0; n <= max_number; ++n) {
-        BaseOut b = base_syllables(n);
-        int adj_zeroes = b.zeroes;
-        if (adj_zeroes > 3) adj_zeroes = (adj_zeroes / 3) * 3;
+private:
+    // Same op kind and left operand, so the same words once spoken.
+    static bool same_phrasing(uint64_t a, uint64_t b) {
+        const uint64_t ra = rank_mask - (a & rank_mask), rb = rank_mask - (b & rank_mask);
+        if ((ra & rank_left_mask) != (rb & rank_left_mask)) return false;
+        return phrasing_kind((int)(ra >> rank_op_shift)) == phrasing_kind((int)(rb >> rank_op_shift));
+    }
+    static int phrasing_kind(int order) {
+        if (order == 0) return -1;
+        if (order <= (int)binary_ops.size()) return (int)binary_ops[order - 1].kind;
+        return (int)unary_ops[order - 1 - binary_ops.size()].kind;
+    }
+
+    int k_{};
+    FillArray<std::atomic<uint64_t>> words_;   // [count][k]
+    FillArray<std::atomic<uint8_t>> locks_;    // one per number, held while its list changes
+};
+
+// Last level a build with lists searches: the range's largest plain count plus
+// the dearest op. A list still short of k forms by then keeps the ones it has.
+static int alt_last_level(int max_syllables) {
+    int dearest = 0;
+    for (const auto& op : binary_ops) dearest = std::max(dearest, op.syllables);
+    for (const auto& op : unary_ops) dearest = std::max(dearest, op.syllables);
+    return max_syllables + dearest;
+}
 
-        Entry e;
-        e.value = n;
-        e.syllables.assign(pemdas_count, b.n_syl);
-        e.names.assign(pemdas_count, b.n_name);
-        e.equations.assign(pemdas_count, std::to_string(n));
+// -------- frontier sets --------
+// One syllable_key[s][u] set over [0, max_number]: a dense bitset that commits
+// set concurrently, plus the sorted value list the pair loops index into. The
+// list is built by a ctz scan the first time it is asked for, which the
+// generator only does once a level is complete.
+class Frontier {
+public:
+    explicit Frontier(int count = 0) : words_((size_t)(count + 63) / 64) {}
+
+    bool contains(int n) const {
+        return (words_[(size_t)n >> 6].load(std::memory_order_relaxed) >> (n & 63)) & 1;
+    }
+    void insert(int n) { words_[(size_t)n >> 6].fetch_or(1ull << (n & 63), std::memory_order_relaxed); }
+
+    // Plain store for fills where each word has a single writer.
+    void store_word(size_t w, uint64_t bits) { words_[w].store(bits, std::memory_order_relaxed); }
+    uint64_t word(size_t w) const { return words_[w].load(std::memory_order_relaxed); }
+    size_t word_count() const { return words_.size(); }
+
+    // fn(n) for every member in [lo, hi], in increasing order.
+    template <class Func>
+    void for_each_in(int lo, int hi, Func&& fn) const {
+        lo = std::max(lo, 0);
+        hi = std::min<long long>(hi, (long long)words_.size() * 64 - 1);
+        if (lo > hi) return;
+        const size_t wlo = (size_t)lo >> 6, whi = (size_t)hi >> 6;
+        for (size_t w = wlo; w <= whi; ++w) {
+            uint64_t bits = word(w);
+            if (w == wlo) bits &= ~0ull << (lo & 63);
+            if (w == whi && (hi & 63) != 63) bits &= (1ull << ((hi & 63) + 1)) - 1;
+            for (; bits; bits &= bits - 1) fn((int)(w * 64) + __builtin_ctzll(bits));
+        }
+    }
+
+    // The bitset as plain words; only valid while no inserts are in flight.
+    const uint64_t* raw_words() const { return reinterpret_cast<const uint64_t*>(words_.data()); }
+
+    const vector<int>& values() const {
+        if (!built_) {
+            size_t total = 0;
+            for (const auto& w : words_) total += (size_t)__builtin_popcountll(w.load(std::memory_order_relaxed));
+            values_.reserve(total);
+            for (size_t w = 0; w < words_.size(); ++w) {
+                for (uint64_t bits = word(w); bits; bits &= bits - 1) {
+                    values_.push_back((int)(w * 64) + __builtin_ctzll(bits));
+                }
+            }
+            built_ = true;
+        }
+        return values_;
+    }
 
-        e.syllables[0] = b.frac_syl;
-        e.names[0] = b.frac_name;
+private:
+    vector<std::atomic<uint64_t>> words_;
+    mutable vector<int> values_;
+    mutable bool built_{false};
+};
 
-        e.original = b.n_syl;
-        e.zeroes = adj_zeroes;
-        e.digits = b.digits;
-        e.nonzero = b.digits - b.zeroes;
-        e.auto_pass = ((n % 100 < 20 && n % 100 > 0) || b.zeroes < 1 || b.digits < 3);
+// Bit i set where bytes[i] >= s, for 64 bytes below 128: eight at a time, each
+// byte's high bit after (byte | 0x80) - s, gathered by one multiply.
+static uint64_t bytes_at_least(const uint8_t* bytes, int s) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+        uint64_t x;
+        std::memcpy(&x, bytes + 8 * i, sizeof x);
+        const uint64_t high = ((x | 0x8080808080808080ull) - 0x0101010101010101ull * (uint64_t)s) &
+                              0x8080808080808080ull;
+        bits |= (((high >> 7) * 0x0102040810204080ull) >> 56) << (8 * i);
+    }
+    return bits;
+}
 
-        number_names.push_back(std::move(e));
-        max_syllables = std::max(max_syllables, b.n_syl);
+// The numbers whose slot at one pemdas level can still take a level-s derivation
+// (syllables >= s, ties included: a later rank can still replace the word), as a
+// bitset plus one summary bit per nonzero word, so asking whether anything in
+// [lo, hi] is open reads two edge words and a few summary words.
+class OpenIndex {
+public:
+    explicit OpenIndex(int count = 0) : words_((size_t)(count + 63) / 64), summary_((words_.size() + 63) / 64) {}
+
+    // Each word has a single writer; summarize() once they are all stored.
+    void store_word(size_t w, uint64_t bits) { words_[w] = bits; }
+    void summarize() {
+        std::fill(summary_.begin(), summary_.end(), 0);
+        for (size_t w = 0; w < words_.size(); ++w) summary_[w >> 6] |= (uint64_t)(words_[w] != 0) << (w & 63);
     }
 
-    // Special-case: "halve"
-    if (max_number >= 2) {
-        number_names[2].syllables[0] = 1;
-        number_names[2].names[0] = "halve";
+    const uint64_t* raw_words() const { return words_.data(); }
+
+    bool any_in(long long lo, long long hi) const {
+        lo = std::max(lo, 0LL);
+        hi = std::min(hi, (long long)words_.size() * 64 - 1);
+        if (lo > hi) return false;
+        const size_t wlo = (size_t)lo >> 6, whi = (size_t)hi >> 6;
+        if (wlo == whi) return (words_[wlo] & span_mask(lo & 63, hi & 63)) != 0;
+        if ((words_[wlo] & span_mask(lo & 63, 63)) || (words_[whi] & span_mask(0, hi & 63))) return true;
+        if (wlo + 1 == whi) return false;
+        const size_t slo = (wlo + 1) >> 6, shi = (whi - 1) >> 6;
+        const int blo = (int)((wlo + 1) & 63), bhi = (int)((whi - 1) & 63);
+        if (slo == shi) return (summary_[slo] & span_mask(blo, bhi)) != 0;
+        if ((summary_[slo] & span_mask(blo, 63)) || (summary_[shi] & span_mask(0, bhi))) return true;
+        for (size_t i = slo + 1; i < shi; ++i) {
+            if (summary_[i]) return true;
+        }
+        return false;
     }
 
-    vector<vector<vector<int>>> syllable_key;
-    syllable_key.resize(1);
-    syllable_key[0].resize(pemdas_count);
+private:
+    static uint64_t span_mask(int lo, int hi) { return (~0ull << lo) & (~0ull >> (63 - hi)); }
 
-    vector<UnaryOp> unary = {
-        {"²", 1, " squared", 2, 2, 2},
-        {"³", 1, " cubed",   3, 2, 2},
-    };
+    vector<uint64_t> words_;
+    vector<uint64_t> summary_;
+};
+
+// For output words covering [out_lo, out_hi], take the 64 bits of `set` that
+// start at bit 64 * j + delta (so out = member - delta), keep those also set
+// in `live`, and call fn(out) for each. This is the whole "+"/"-" pair loop
+// as word-parallel shift-AND; bits outside `set` read as zero.
+// Below this many candidate pairs per output word the sorted-list walk wins.
+#ifdef __AVX2__
+static constexpr long long shift_pairs_per_word = 8;
+#else
+static constexpr long long shift_pairs_per_word = 16;
+#endif
 
-    vector<BinaryOp> binary = {
-        {"+", 1, " plus ",  "", 5, 5, 5},
-        {"*", 1, " times ", "", 3, 4, 4},
-        {"*", 1, " times ", "", 3, 3, 3},
-        {"-", 2, " minus ", "", 5, 4, 5},
-        {"/", 2, " over ",  "", 3, 2, 4},
-        {"fraction", 0, " ", "s", 2, 0, 2},
-        {"^", 2, " to the ", "", 2, 0, 2},
+template <class Func>
+static void for_each_shifted(const uint64_t* set, long long set_words, const uint64_t* live,
+                             long long delta, int out_lo, int out_hi, Func&& fn) {
+    if (out_lo > out_hi) return;
+    const long long q = delta >= 0 ? delta / 64 : -((-delta + 63) / 64);
+    const unsigned b = (unsigned)(delta - q * 64);
+
+    auto src = [&](long long i) -> uint64_t { return (i >= 0 && i < set_words) ? set[i] : 0; };
+    auto shifted_word = [&](long long j) -> uint64_t {
+        const uint64_t lo = src(j + q);
+        return b == 0 ? lo : (lo >> b) | (src(j + q + 1) << (64 - b));
+    };
+    auto emit = [&](long long j, uint64_t bits) {
+        for (; bits; bits &= bits - 1) fn((int)(j * 64 + __builtin_ctzll(bits)));
     };
 
-    int min_missing = 1;
+    const long long j_lo = out_lo / 64, j_hi = out_hi / 64;
+    for (long long j = j_lo; j <= j_hi; ++j) {
+#ifdef __AVX2__
+        // Four output words at once while every source word is in range.
+        if (j > j_lo && j + 4 <= j_hi && j + q >= 0 && j + q + 4 < set_words) {
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(set + j + q));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(set + j + q + 1));
+            const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(live + j));
+            __m256i w = _mm256_srl_epi64(lo, _mm_cvtsi32_si128((int)b));
+            if (b != 0) w = _mm256_or_si256(w, _mm256_sll_epi64(hi, _mm_cvtsi32_si128((int)(64 - b))));
+            w = _mm256_and_si256(w, mask);
+            if (!_mm256_testz_si256(w, w)) {
+                alignas(32) uint64_t out[4];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(out), w);
+                for (int k = 0; k < 4; ++k) emit(j + k, out[k]);
+            }
+            j += 3;
+            continue;
+        }
+#endif
+        uint64_t mask = live[j];
+        if (j == j_lo) mask &= ~0ull << (out_lo & 63);
+        if (j == j_hi && (out_hi & 63) != 63) mask &= (1ull << ((out_hi & 63) + 1)) - 1;
+        if (!mask) continue;
+        emit(j, shifted_word(j) & mask);
+    }
+}
 
-    // striped locks for number_names updates
-    static constexpr int LOCK_STRIPES = 8192;
-    vector<std::mutex> stripes(LOCK_STRIPES);
-    auto lock_for = [&](int out) -> std::mutex& { return stripes[(unsigned)out % LOCK_STRIPES]; };
+// -------- small parallel helpers --------
+static int default_threads() {
+    unsigned hc = std::thread::hardware_concurrency();
+    return (hc == 0 ? 4 : (int)hc);
+}
 
-    int threads = default_threads();
+// -------- work-stealing thread pool --------
+// Workers are started once and reused by every parallel_for. Each call hands
+// every worker one contiguous slice of [begin, end); a worker takes `grain`
+// items at a time from the front of its own slice and, once that is empty,
+// steals the back half of another worker's slice. The calling thread works as
+// worker 0.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads) : slices_(std::max(1, threads)) {
+        for (int w = 1; w < (int)slices_.size(); ++w) {
+            workers_.emplace_back([this, w]() { worker_main(w); });
+        }
+    }
 
-    for (int s = 1; s <= max_syllables; ++s) {
-        if (show_progress) {
-            std::cout << "searching " << s << " syllables, at " << min_missing << "\n";
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> g(job_mutex_);
+            stopping_ = true;
         }
+        job_ready_.notify_all();
+        for (auto& th : workers_) th.join();
+    }
 
-        syllable_key.resize(s + 1);
-        syllable_key[s].assign(pemdas_count, {});
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
 
-        // ---- Fill syllable_key[s][u] in parallel ----
-        vector<vector<vector<int>>> locals(threads, vector<vector<int>>(pemdas_count));
-        parallel_for_chunks(min_missing, max_number + 1, threads, [&](int b, int e) {
-            // map this worker to an index by hashing the thread id is annoying;
-            // instead: use a small per-call static counter is also annoying.
-            // Simple approach: allocate by chunk-start index -> deterministic worker slot:
-            int slot = (b - min_missing) * threads / std::max(1, (max_number + 1 - min_missing));
-            if (slot < 0) slot = 0;
-            if (slot >= threads) slot = threads - 1;
+    int size() const { return (int)slices_.size(); }
 
-            auto& local = locals[slot];
-            for (int n = b; n < e; ++n) {
-                for (int u = 0; u < pemdas_count; ++u) {
-                    int cur = number_names[n].syllables[u];
-                    if (cur < s) break;
-                    if (cur == s) {
-                        local[u].push_back(n);
-                    } else if (u > 0) {
-                        break;
-                    }
-                }
+    // Grain that leaves every worker many pieces to balance with.
+    int grain_for(int items) const { return std::max(1, items / (size() * 32)); }
+
+    // fn(b, e, worker) is called on disjoint sub-ranges covering [begin, end);
+    // `worker` is in [0, size()) and is never used by two calls at once.
+    template <class Func>
+    void parallel_for(int begin, int end, int grain, Func&& fn) {
+        if (end <= begin) return;
+        grain = std::max(1, grain);
+        const int workers = size();
+        if (workers == 1 || end - begin <= grain) {
+            fn(begin, end, 0);
+            return;
+        }
+
+        const long long total = end - begin;
+        for (int w = 0; w < workers; ++w) {
+            slices_[w].begin = begin + (int)(total * w / workers);
+            slices_[w].end = begin + (int)(total * (w + 1) / workers);
+        }
+
+        using F = std::remove_reference_t<Func>;
+        job_ = [](void* ctx, int b, int e, int w) { (*static_cast<F*>(ctx))(b, e, w); };
+        job_ctx_ = &fn;
+        job_grain_ = grain;
+        {
+            std::lock_guard<std::mutex> g(job_mutex_);
+            pending_ = workers - 1;
+            ++generation_;
+        }
+        job_ready_.notify_all();
+
+        run_slices(0);
+
+        std::unique_lock<std::mutex> lk(job_mutex_);
+        job_done_.wait(lk, [this]() { return pending_ == 0; });
+    }
+
+private:
+    struct alignas(64) Slice {
+        std::mutex m;
+        int begin{};
+        int end{};
+    };
+
+    void worker_main(int w) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lk(job_mutex_);
+                job_ready_.wait(lk, [&]() { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
             }
-        });
+            run_slices(w);
+            {
+                std::lock_guard<std::mutex> g(job_mutex_);
+                if (--pending_ == 0) job_done_.notify_one();
+            }
+        }
+    }
 
-        for (int u = 0; u < pemdas_count; ++u) {
-            for (int t = 0; t < threads; ++t) {
-                auto& v = locals[t][u];
-                if (!v.empty()) {
-                    syllable_key[s][u].insert(syllable_key[s][u].end(), v.begin(), v.end());
-                }
+    bool take_own(int w, int& b, int& e) {
+        Slice& mine = slices_[w];
+        std::lock_guard<std::mutex> g(mine.m);
+        if (mine.begin >= mine.end) return false;
+        b = mine.begin;
+        e = std::min(mine.end, b + job_grain_);
+        mine.begin = e;
+        return true;
+    }
+
+    bool steal(int w) {
+        const int workers = size();
+        for (int k = 1; k < workers; ++k) {
+            Slice& victim = slices_[(w + k) % workers];
+            int b, e;
+            {
+                std::lock_guard<std::mutex> g(victim.m);
+                int left = victim.end - victim.begin;
+                if (left <= 0) continue;
+                int mid = victim.begin + left / 2;
+                b = mid;
+                e = victim.end;
+                victim.end = mid;
             }
-            std::sort(syllable_key[s][u].begin(), syllable_key[s][u].end());
-            syllable_key[s][u].erase(std::unique(syllable_key[s][u].begin(), syllable_key[s][u].end()),
-                                     syllable_key[s][u].end());
+            Slice& mine = slices_[w];
+            std::lock_guard<std::mutex> g(mine.m);
+            mine.begin = b;
+            mine.end = e;
+            return true;
         }
+        return false;
+    }
 
-        // ---- Binary ops (parallel over left_list chunks) ----
-        for (const auto& op : binary) {
-            auto [min_left, max_left] = get_first_extremes(op.id, min_missing, max_number);
+    void run_slices(int w) {
+        int b, e;
+        for (;;) {
+            while (take_own(w, b, e)) job_(job_ctx_, b, e, w);
+            if (!steal(w)) return;
+        }
+    }
 
-            for (int left_syl = 0; left_syl < s - op.syllables; ++left_syl) {
-                const auto& left_list = syllable_key[left_syl][op.pemdas_left];
-                if (left_list.empty()) continue;
+    vector<Slice> slices_;
+    vector<std::thread> workers_;
 
-                int right_syl = s - op.syllables - left_syl;
-                if (right_syl < 0) continue;
-                const auto& right_list = syllable_key[right_syl][op.pemdas_right];
-                if (right_list.empty()) continue;
+    void (*job_)(void*, int, int, int){};
+    void* job_ctx_{};
+    int job_grain_{1};
 
-                // thread-local new outs per pemdas u
-                vector<vector<vector<int>>> newouts_locals(threads, vector<vector<int>>(pemdas_count));
+    std::mutex job_mutex_;
+    std::condition_variable job_ready_;
+    std::condition_variable job_done_;
+    uint64_t generation_{};
+    int pending_{};
+    bool stopping_{};
+};
 
-                parallel_for_chunks(0, (int)left_list.size(), threads, [&](int bi, int ei) {
-                    int slot = bi * threads / std::max(1, (int)left_list.size());
-                    if (slot < 0) slot = 0;
-                    if (slot >= threads) slot = threads - 1;
+// Syllables and digit facts of the plain number n, put together from the facts
+// of its parts: `part(m)` (m < n) returns m's BaseOut with zeroes as stored.
+template <class Part>
+static BaseOut compose_base(long long n, const Part& part) {
+    if (n < 20) {
+        return { one_names[n].cardSyl, one_names[n].ordSyl, 0, 1 };
+    } else if (n < 100) {
+        int n_mod = (int)(n % 10);
+        int n_div = (int)(n / 10);
 
-                    auto& newouts = newouts_locals[slot];
+        if (n_mod == 0) {
+            const auto& t = ten_names[n_div];
+            return { t.cardSyl, t.ordSyl, 1, 2 };
+        }
 
-                    for (int idx = bi; idx < ei; ++idx) {
-                        int left_value = left_list[idx];
-                        if (left_value < min_left) continue;
-                        if (left_value > max_left) break;
-
-                        auto [min_right, max_right] = get_second_extremes(op.id, min_missing, max_number, left_value);
-
-                        for (int right_value : right_list) {
-                            if (right_value < min_right) continue;
-                            if (right_value > max_right) break;
-
-                            if (op.id == "fraction") {
-                                const auto& L = number_names[left_value];
-                                const auto& R = number_names[right_value];
-                                if (!L.auto_pass &&
-                                    right_value != 2 &&
-                                    L.zeroes >= R.digits &&
-                                    (L.nonzero > 1 || R.nonzero > 1) &&
-                                    L.names[1] == L.names[2]) {
-                                    continue;
-                                }
-                            }
+        const auto& t = ten_names[n_div];
+        const BaseOut m = part(n_mod);
 
-                            if (op.id == "^" && (size_t)right_value >= superscripts.size()) {
-                                continue;
-                            }
+        return { t.cardSyl + m.n_syl, t.cardSyl + m.frac_syl, 0, 2 };
+    }
 
-                            auto [out_ll, ok] = get_output(op.id, left_value, right_value);
-                            if (!ok) continue;
-                            if (out_ll < 0 || out_ll > max_number) continue;
-                            int out = (int)out_ll;
+    int large_index = 0;
+    while (large_index + 1 < (int)large_names.size() && large_names[large_index + 1].base <= n) {
+        large_index++;
+    }
 
-                            string new_name =
-                                number_names[left_value].names[op.pemdas_left] +
-                                op.text +
-                                number_names[right_value].names[op.pemdas_right] +
-                                op.suffix;
+    const auto& L = large_names[large_index];
+    long long n_mod = n % L.base;
+    long long n_div = n / L.base;
 
-                            string new_equation = number_names[left_value].equations[op.pemdas_left];
+    const BaseOut d = part(n_div);
 
-                            if (op.id == "^") {
-                                if (new_equation == number_names[left_value].equations[1]) {
-                                    new_equation = new_equation + " " + superscripts[right_value];
-                                } else {
-                                    new_equation = "(" + new_equation + ") " + superscripts[right_value];
-                                }
-                            } else {
-                                if (op.id == "fraction") new_equation += " / ";
-                                else new_equation += " " + op.id + " ";
-                                new_equation += number_names[right_value].equations[op.pemdas_right];
-                            }
+    if (n_mod == 0) {
+        return {
+            d.n_syl + L.syl,
+            d.n_syl + L.syl,
+            L.zeroesAdd + d.zeroes,
+            L.zeroesAdd + d.digits
+        };
+    }
 
-                            // commit updates under a stripe lock
-                            {
-                                std::lock_guard<std::mutex> g(lock_for(out));
-                                for (int u = op.pemdas_result; u < pemdas_count; ++u) {
-                                    if (number_names[out].syllables[u] >= s) {
-                                        number_names[out].names[u] = new_name;
-                                        number_names[out].equations[u] = new_equation;
-
-                                        if (number_names[out].syllables[u] > s) {
-                                            number_names[out].syllables[u] = s;
-                                            newouts[u].push_back(out);
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                });
+    int connect_syll = 0;
+    const BaseOut m = part(n_mod);
 
-                // merge new outs into syllable_key[s][u]
-                for (int u = 0; u < pemdas_count; ++u) {
-                    for (int t = 0; t < threads; ++t) {
-                        auto& v = newouts_locals[t][u];
-                        if (!v.empty()) {
-                            syllable_key[s][u].insert(syllable_key[s][u].end(), v.begin(), v.end());
-                        }
-                    }
-                    std::sort(syllable_key[s][u].begin(), syllable_key[s][u].end());
-                    syllable_key[s][u].erase(std::unique(syllable_key[s][u].begin(), syllable_key[s][u].end()),
-                                             syllable_key[s][u].end());
-                }
-            }
-        }
+    return {
+        d.n_syl + L.syl + connect_syll + m.n_syl,
+        d.n_syl + L.syl + connect_syll + m.frac_syl,
+        m.zeroes,
+        L.zeroesAdd + d.digits
+    };
+}
 
-        // ---- Unary ops (parallel over input list chunks) ----
-        for (const auto& op : unary) {
-            if (s <= op.syllables) continue;
+// Trailing zeroes as the table stores them: whole groups of three past 3.
+static int stored_zeroes(int zeroes) {
+    return zeroes > 3 ? (zeroes / 3) * 3 : zeroes;
+}
 
-            auto [min_val, max_val] = get_first_extremes(op.id, min_missing, max_number);
-            int in_syl = s - op.syllables;
-            if (in_syl < 0) continue;
+// Base fill step: the parts of n are already in the table.
+static BaseOut base_syllables(const NumberTable& table, int n) {
+    return compose_base(n, [&table](long long m) {
+        return BaseOut{ table.syl(1)[m], table.syl(0)[m], table.zeroes[m], table.digits[m] };
+    });
+}
 
-            const auto& in_list = syllable_key[in_syl][op.pemdas_input];
-            if (in_list.empty()) continue;
+// The same facts for a number with no table behind it (zeroes not yet stored).
+static BaseOut plain_base(long long n) {
+    return compose_base(n, [](long long m) {
+        BaseOut b = plain_base(m);
+        b.zeroes = stored_zeroes(b.zeroes);
+        return b;
+    });
+}
 
-            vector<vector<vector<int>>> newouts_locals(threads, vector<vector<int>>(pemdas_count));
+// "fraction" naming rule: refuse "<left> <right>ths" when left is plain, ends in
+// at least as many zeroes as right has digits and either side has more than one
+// significant digit. auto_pass lefts and halves always read fine.
+static bool fraction_rejected(bool left_auto_pass, int left_zeroes, int left_nonzero, bool left_plain,
+                              int right_value, int right_digits, int right_nonzero) {
+    return !left_auto_pass && right_value != 2 && left_zeroes >= right_digits &&
+           (left_nonzero > 1 || right_nonzero > 1) && left_plain;
+}
 
-            parallel_for_chunks(0, (int)in_list.size(), threads, [&](int bi, int ei) {
-                int slot = bi * threads / std::max(1, (int)in_list.size());
-                if (slot < 0) slot = 0;
-                if (slot >= threads) slot = threads - 1;
+// Spelled-out plain number (cardinal or ordinal), mirroring base_syllables.
+static string base_name(long long n, bool ordinal) {
+    if (n < 20) return ordinal ? one_names[n].ord : one_names[n].card;
+    if (n < 100) {
+        const auto& t = ten_names[n / 10];
+        if (n % 10 == 0) return ordinal ? t.ord : t.card;
+        return t.card + "-" + base_name(n % 10, ordinal);
+    }
 
-                auto& newouts = newouts_locals[slot];
+    int large_index = 0;
+    while (large_index + 1 < (int)large_names.size() && large_names[large_index + 1].base <= n) {
+        large_index++;
+    }
 
-                for (int idx = bi; idx < ei; ++idx) {
-                    int input_value = in_list[idx];
-                    if (input_value < min_val) continue;
-                    if (input_value > max_val) break;
+    const auto& L = large_names[large_index];
+    string head = base_name(n / L.base, false) + " " + L.word;
+    if (n % L.base == 0) return ordinal ? head + "th" : head;
 
-                    auto [out_ll, ok] = get_output(op.id, input_value);
-                    if (!ok) continue;
-                    if (out_ll < 0 || out_ll > max_number) continue;
-                    int out = (int)out_ll;
+    string connect_word = " ";
+    return head + connect_word + base_name(n % L.base, ordinal);
+}
 
-                    string new_name = number_names[input_value].names[op.pemdas_input] + op.text;
+// Rebuild the name / equation of (n, u) by following winning derivations.
+// `derivs(n, u)` returns the Derivation for that slot (by value or reference).
+template <class Derivs>
+static string derivation_name(const Derivs& derivs, long long n, int u) {
+    const Derivation d = derivs(n, u);
+    switch (d.kind) {
+    case DerivKind::Unary:
+        return derivation_name(derivs, d.left, d.left_level) + unary_ops[d.op].text;
+    case DerivKind::Binary: {
+        const auto& op = binary_ops[d.op];
+        return derivation_name(derivs, d.left, d.left_level) + op.text +
+               derivation_name(derivs, d.right, d.right_level) + op.suffix;
+    }
+    case DerivKind::Base:
+        break;
+    }
+    if (u == 0 && n == 2) return "halve";
+    return base_name(n, u == 0);
+}
 
-                    string new_equation = number_names[input_value].equations[op.pemdas_input];
-                    if (new_equation == number_names[input_value].equations[1]) {
-                        new_equation = new_equation + " " + op.id;
-                    } else {
-                        new_equation = "(" + new_equation + ") " + op.id;
-                    }
+template <class Derivs>
+static string derivation_equation(const Derivs& derivs, long long n, int u) {
+    const Derivation d = derivs(n, u);
+    if (d.kind == DerivKind::Base) return std::to_string(n);
 
-                    {
-                        std::lock_guard<std::mutex> g(lock_for(out));
-                        for (int u = op.pemdas_result; u < pemdas_count; ++u) {
-                            if (number_names[out].syllables[u] >= s) {
-                                number_names[out].names[u] = new_name;
-                                number_names[out].equations[u] = new_equation;
+    string left = derivation_equation(derivs, d.left, d.left_level);
+    bool left_plain = derivs(d.left, d.left_level).kind == DerivKind::Base;
 
-                                if (number_names[out].syllables[u] > s) {
-                                    number_names[out].syllables[u] = s;
-                                    newouts[u].push_back(out);
-                                }
-                            }
-                        }
-                    }
-                }
-            });
+    if (d.kind == DerivKind::Unary) {
+        const string& id = unary_ops[d.op].id;
+        return left_plain ? left + " " + id : "(" + left + ") " + id;
+    }
 
-            for (int u = 0; u < pemdas_count; ++u) {
-                for (int t = 0; t < threads; ++t) {
-                    auto& v = newouts_locals[t][u];
-                    if (!v.empty()) {
-                        syllable_key[s][u].insert(syllable_key[s][u].end(), v.begin(), v.end());
-                    }
-                }
-                std::sort(syllable_key[s][u].begin(), syllable_key[s][u].end());
-                syllable_key[s][u].erase(std::unique(syllable_key[s][u].begin(), syllable_key[s][u].end()),
-                                         syllable_key[s][u].end());
-            }
+    const auto& op = binary_ops[d.op];
+    if (op.kind == OpKind::Power) {
+        return left_plain ? left + " " + superscripts[d.right] : "(" + left + ") " + superscripts[d.right];
+    }
+    return left + (op.kind == OpKind::Fraction ? " / " : " " + op.id + " ") +
+           derivation_equation(derivs, d.right, d.right_level);
+}
+
+// Smallest prime factor of every n in [0, max_number] (0 and 1 map to themselves).
+static vector<int> smallest_prime_factors(int max_number) {
+    vector<int> spf(max_number + 1);
+    for (int n = 0; n <= max_number; ++n) spf[n] = n;
+    for (long long p = 2; p * p <= max_number; ++p) {
+        if (spf[p] != p) continue;
+        for (long long m = p * p; m <= max_number; m += p) {
+            if (spf[m] == m) spf[m] = (int)p;
         }
+    }
+    return spf;
+}
 
-        // Advance min_missing
-        while (min_missing <= leave_point && number_names[min_missing].syllables.back() <= s) {
-            min_missing++;
+// All divisors of n >= 1 (unordered) into `out`, reusing its storage.
+static void list_divisors(int n, const vector<int>& spf, vector<int>& out) {
+    out.clear();
+    out.push_back(1);
+    while (n > 1) {
+        const int p = spf[n];
+        int power = 0;
+        while (n % p == 0) {
+            n /= p;
+            ++power;
+        }
+        const size_t existing = out.size();
+        for (size_t i = 0; i < existing; ++i) {
+            int d = out[i];
+            for (int k = 0; k < power; ++k) {
+                d *= p;
+                out.push_back(d);
+            }
         }
-        if (min_missing > leave_point) break;
     }
 }
 
-static void print_usage() {
-    std::cout <<
-        "Usage: saynum <number> [--quiet] [--show name|equation|both|all]\n"
-        "Example: ./saynum 27 --quiet --show both\n";
+// Factoring past any table: Miller-Rabin (deterministic for 64-bit inputs with
+// these bases) and Pollard's rho, after trial division by small numbers.
+static uint64_t mul_mod(uint64_t a, uint64_t b, uint64_t m) {
+    return (uint64_t)((unsigned __int128)a * b % m);
 }
 
-int main(int argc, char** argv) {
-    if (argc < 2) {
-        print_usage();
-        return 1;
+static uint64_t pow_mod(uint64_t a, uint64_t e, uint64_t m) {
+    uint64_t r = 1;
+    for (a %= m; e; e >>= 1, a = mul_mod(a, a, m)) {
+        if (e & 1) r = mul_mod(r, a, m);
     }
+    return r;
+}
 
-    long long n_ll = 0;
-    try {
-        n_ll = std::stoll(argv[1]);
-    } catch (...) {
-        std::cerr << "Invalid number.\n";
-        return 1;
+static bool is_prime(uint64_t n) {
+    if (n < 2) return false;
+    for (uint64_t p : { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 }) {
+        if (n % p == 0) return n == p;
     }
-    if (n_ll < 0) {
-        std::cerr << "Only non-negative integers are supported.\n";
-        return 1;
+    uint64_t d = n - 1;
+    int s = 0;
+    for (; (d & 1) == 0; d >>= 1) ++s;
+    for (uint64_t a : { 2ull, 325ull, 9375ull, 28178ull, 450775ull, 9780504ull, 1795265022ull }) {
+        uint64_t x = pow_mod(a, d, n);
+        if (x == 0 || x == 1 || x == n - 1) continue;
+        int i = 1;
+        for (; i < s && x != n - 1; ++i) x = mul_mod(x, x, n);
+        if (x != n - 1) return false;
     }
-    if (n_ll > 2000000) {
-        std::cerr << "Refusing: number too large for a fresh full recompute in reasonable time.\n";
-        std::cerr << "Try <= 2,000,000 or remove this guard in the source.\n";
-        return 1;
+    return true;
+}
+
+// Some nontrivial factor of an odd composite n.
+static uint64_t rho_factor(uint64_t n) {
+    for (uint64_t c = 1;; ++c) {
+        auto f = [&](uint64_t z) { return (mul_mod(z, z, n) + c) % n; };
+        uint64_t x = 2, y = 2, d = 1;
+        while (d == 1) {
+            x = f(x);
+            y = f(f(y));
+            d = std::gcd(x > y ? x - y : y - x, n);
+        }
+        if (d != n) return d;
     }
-    int n = (int)n_ll;
+}
 
-    bool quiet = false;
-    string show = "both";
+// Prime factors of n >= 1 with multiplicity, ascending, into `out`.
+static void prime_factors(uint64_t n, vector<uint64_t>& out) {
+    out.clear();
+    for (uint64_t p = 2; p < 100 && p * p <= n; ++p) {
+        for (; n % p == 0; n /= p) out.push_back(p);
+    }
+    vector<uint64_t> rest;
+    if (n > 1) rest.push_back(n);
+    while (!rest.empty()) {
+        const uint64_t m = rest.back();
+        rest.pop_back();
+        if (m < 100 * 100 || is_prime(m)) {
+            out.push_back(m);
+        } else {
+            const uint64_t d = rho_factor(m);
+            rest.push_back(d);
+            rest.push_back(m / d);
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
+
+struct LevelReport {
+    int syllables;
+    double seconds;
+    uint64_t candidates;   // derivations offered to a slot
+    uint64_t pruned;       // (op, left_syl) splits skipped: no output in reach was still open
+};
+
+struct GeneratorReport {
+    double base_fill_seconds{};
+    vector<LevelReport> levels;
+
+    uint64_t candidates() const {
+        uint64_t total = 0;
+        for (const auto& l : levels) total += l.candidates;
+        return total;
+    }
+};
+
+// Hot-path counters for one (syllable level, op, left_syl) split, from --stats.
+struct OpStats {
+    uint64_t pairs{};             // candidate pairs looked at
+    uint64_t bound_rejects{};     // outside the op's operand bounds
+    uint64_t output_failures{};   // no integer output, or output out of range
+    uint64_t fraction_rejects{};  // refused by the fraction naming rule
+    uint64_t settled{};           // "+"/"-" outputs already below this level
+    uint64_t pruned{};            // left operands skipped: no output in reach was still open
+    uint64_t shift_words{};       // output words run through the shift kernel
+    uint64_t commits{};           // offers that replaced a slot word
+    uint64_t improvements{};      // ... and lowered its syllable count
+    uint64_t cas_retries{};       // lost compare-exchange races (contention)
+    double seconds{};
+
+    OpStats& operator+=(const OpStats& o) {
+        pairs += o.pairs;
+        bound_rejects += o.bound_rejects;
+        output_failures += o.output_failures;
+        fraction_rejects += o.fraction_rejects;
+        settled += o.settled;
+        pruned += o.pruned;
+        shift_words += o.shift_words;
+        commits += o.commits;
+        improvements += o.improvements;
+        cas_retries += o.cas_retries;
+        seconds += o.seconds;
+        return *this;
+    }
+};
+
+struct SplitStats {
+    int syllables;
+    int op_order;     // 1-based: binary_ops, then unary_ops (as in op_rank)
+    int left_syl;     // input syllables for unary ops
+    OpStats counts;
+};
+
+struct GeneratorStats {
+    vector<SplitStats> splits;
+};
+
+static string op_label(int op_order) {
+    if (op_order <= (int)binary_ops.size()) {
+        const auto& op = binary_ops[op_order - 1];
+        return op.id + "@" + std::to_string(op.pemdas_result);
+    }
+    const auto& op = unary_ops[op_order - 1 - (int)binary_ops.size()];
+    return op.id + "@" + std::to_string(op.pemdas_result);
+}
+
+static void print_stats_text(const GeneratorStats& stats, std::ostream& os) {
+    char line[256];
+    std::snprintf(line, sizeof line, "%3s %-11s %4s %12s %10s %10s %9s %10s %8s %10s %10s %10s %8s %9s\n",
+                  "syl", "op", "left", "pairs", "bounds", "no_output", "fraction", "settled", "pruned", "shift_wds",
+                  "commits", "improved", "retries", "seconds");
+    os << line;
+    for (const auto& sp : stats.splits) {
+        const auto& c = sp.counts;
+        // Padded by code points, not bytes: "²" and "³" take two bytes but one column.
+        string label = op_label(sp.op_order);
+        const auto width = std::count_if(label.begin(), label.end(), [](char ch) { return (ch & 0xC0) != 0x80; });
+        if (width < 11) label.append((size_t)(11 - width), ' ');
+        std::snprintf(line, sizeof line,
+                      "%3d %s %4d %12llu %10llu %10llu %9llu %10llu %8llu %10llu %10llu %10llu %8llu %9.4f\n",
+                      sp.syllables, label.c_str(), sp.left_syl,
+                      (unsigned long long)c.pairs, (unsigned long long)c.bound_rejects,
+                      (unsigned long long)c.output_failures, (unsigned long long)c.fraction_rejects,
+                      (unsigned long long)c.settled, (unsigned long long)c.pruned, (unsigned long long)c.shift_words,
+                      (unsigned long long)c.commits, (unsigned long long)c.improvements,
+                      (unsigned long long)c.cas_retries, c.seconds);
+        os << line;
+    }
+}
+
+static void print_stats_json(const GeneratorStats& stats, std::ostream& os) {
+    os << "{\"splits\": [";
+    for (size_t i = 0; i < stats.splits.size(); ++i) {
+        const auto& sp = stats.splits[i];
+        const auto& c = sp.counts;
+        os << (i ? ",\n  " : "\n  ")
+           << "{\"syllables\": " << sp.syllables << ", \"op\": \"" << op_label(sp.op_order)
+           << "\", \"left_syl\": " << sp.left_syl << ", \"pairs\": " << c.pairs
+           << ", \"bound_rejects\": " << c.bound_rejects << ", \"output_failures\": " << c.output_failures
+           << ", \"fraction_rejects\": " << c.fraction_rejects << ", \"settled\": " << c.settled
+           << ", \"pruned\": " << c.pruned << ", \"shift_words\": " << c.shift_words << ", \"commits\": " << c.commits
+           << ", \"improvements\": " << c.improvements << ", \"cas_retries\": " << c.cas_retries
+           << ", \"seconds\": " << c.seconds << "}";
+    }
+    os << "\n]}\n";
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Finished slot words of an earlier full build over [0, max_number] (leave_point
+// == max_number), laid out as NumberTable::keys: [pemdas_count][max_number + 1].
+struct GeneratorSeed {
+    int max_number;
+    const uint64_t* keys;
+};
+
+// Shared pages the processes of a sharded build meet in after every level. Each
+// publishes its own words of the level's frontier sets, of the plain level-2
+// members (for the fraction rule) and of the numbers whose top level is done
+// (for min_missing), waits for the others, then copies in theirs. Levels
+// alternate between two buffers, so a process can publish level s + 1 while a
+// slower one is still copying level s. Mapped before fork; the children inherit it.
+class ShardExchange {
+public:
+    static constexpr int plain_two = pemdas_count;
+    static constexpr int top_done = pemdas_count + 1;
+    static constexpr int arrays = pemdas_count + 2;
+
+    ShardExchange(int processes, int max_number) : word_count_((size_t)max_number / 64 + 1) {
+        size_ = sizeof(pthread_barrier_t) + 2 * arrays * word_count_ * sizeof(uint64_t);
+        void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) throw std::runtime_error("cannot map shard exchange");
+        base_ = static_cast<char*>(p);
+
+        pthread_barrierattr_t attr;
+        pthread_barrierattr_init(&attr);
+        pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        const int rc = pthread_barrier_init(barrier(), &attr, (unsigned)processes);
+        pthread_barrierattr_destroy(&attr);
+        if (rc != 0) {
+            ::munmap(base_, size_);
+            throw std::runtime_error("cannot set up shard barrier");
+        }
+    }
+    ~ShardExchange() {
+        pthread_barrier_destroy(barrier());
+        ::munmap(base_, size_);
+    }
+    ShardExchange(const ShardExchange&) = delete;
+    ShardExchange& operator=(const ShardExchange&) = delete;
+
+    // Array `a` (a pemdas level's set, plain_two or top_done) of level s.
+    uint64_t* words(int s, int a) {
+        uint64_t* first = reinterpret_cast<uint64_t*>(base_ + sizeof(pthread_barrier_t));
+        return first + ((size_t)(s & 1) * arrays + a) * word_count_;
+    }
+    void wait() { pthread_barrier_wait(barrier()); }
+
+private:
+    pthread_barrier_t* barrier() { return reinterpret_cast<pthread_barrier_t*>(base_); }
+
+    size_t word_count_;
+    size_t size_{};
+    char* base_{};
+};
+
+// One process of a sharded build: it commits only outputs in [lo, hi] (lo a
+// multiple of 64) and holds slot words only for them. Its operands come from
+// anywhere in [0, max_number], so the frontier sets of every level, the base
+// arrays and the factor sieve still cover all of it: about 35 bytes a number in
+// every shard, against 48 a number of its own slice for the slot words.
+struct GeneratorShard {
+    int lo;
+    int hi;
+    ShardExchange* exchange;
+};
+
+// Caller hooks for one build: progress(s, min_missing) before each level, and a
+// stop flag polled between splits. Shards take neither (they must stay in step).
+struct GeneratorControl {
+    std::function<void(int, long long)> progress;
+    const std::atomic<bool>* stop = nullptr;
+};
+
+// The search itself. With WithStats == false every stats update below is a
+// discarded `if constexpr` branch, so the plain build carries no counters.
+// With a seed, the seed's entries are taken as they are and only pairs it never
+// saw are offered: those landing past its range, and those with an operand that
+// is new or was improved here (which can still fix up seeded entries).
+// With a shard, only outputs in [shard->lo, shard->hi] are committed and the
+// other shards' results arrive through the exchange after each level; the
+// pairs offered to each output are the same as in a single-process build.
+// With alts (reset by the caller to its k; no seed or shard), every s-syllable
+// pair goes to its output's list while that list can still take it: the scan
+// floor is min_alt, and levels go on past the table's own stop, until every list
+// up to leave_point is full at or below s or alt_last_level is done. Only the pairs the plain search would
+// look at are committed to the table, so the table itself comes out the same.
+// Returns false if control->stop was raised; the table is then half built.
+template <bool WithStats>
+static bool run_generator(NumberTable& table, int leave_point, int max_number, ThreadPool& pool,
+                          const GeneratorControl* control, GeneratorReport* report, GeneratorStats* stats,
+                          const GeneratorSeed* seed, const GeneratorShard* shard, AltTable* alts) {
+    auto fill_start = std::chrono::steady_clock::now();
+
+    table.reset(max_number);
+    const int shard_lo = shard ? shard->lo : 0;
+    const int shard_hi = shard ? shard->hi : max_number;
+
+    // Base fill, slot words included. base_syllables(table, n) reads only n % 10 below
+    // 100, and n / base and n % base of its large_names entry above, which lie in an
+    // earlier band ([0, 20) reads nothing), so each band fills in parallel once the
+    // bands below it are done.
+    struct alignas(64) WorkerMax { int syllables{}; };
+    vector<WorkerMax> worker_max(pool.size());
+    static constexpr long long base_bands[] = { 20, 100, 1000, 1000000, 1000000000 };
+    long long band_lo = 0;
+    for (size_t band = 0; band <= std::size(base_bands) && band_lo <= max_number; ++band) {
+        const long long band_hi = band < std::size(base_bands) ? std::min<long long>(base_bands[band], max_number + 1LL)
+                                                                : max_number + 1LL;
+        pool.parallel_for((int)band_lo, (int)band_hi, 4096, [&](int b, int e, int worker) {
+            for (int n = b; n < e; ++n) {
+                // A shard's syllable arrays cover only its slice, so it composes each base from scratch.
+                const BaseOut base = shard ? plain_base(n) : base_syllables(table, n);
+                table.original[n] = (uint8_t)base.n_syl;
+                table.zeroes[n] = (uint8_t)stored_zeroes(base.zeroes);
+                table.digits[n] = (uint8_t)base.digits;
+                table.nonzero[n] = (uint8_t)(base.digits - base.zeroes);
+                table.auto_pass[n] = ((n % 100 < 20 && n % 100 > 0) || base.zeroes < 1 || base.digits < 3);
+                worker_max[worker].syllables = std::max(worker_max[worker].syllables, base.n_syl);
+
+                // Another shard's slots are never touched, so their pages are never mapped in.
+                if (n < shard_lo || n > shard_hi) continue;
+                table.syl(0)[n] = (uint8_t)base.frac_syl;
+                table.key(0)[n].store(make_key(base.frac_syl, 0), std::memory_order_relaxed);
+                for (int u = 1; u < pemdas_count; ++u) {
+                    table.syl(u)[n] = (uint8_t)base.n_syl;
+                    table.key(u)[n].store(make_key(base.n_syl, 0), std::memory_order_relaxed);
+                }
+            }
+        });
+        band_lo = band_hi;
+    }
+    int max_syllables = 0;
+    for (const auto& w : worker_max) max_syllables = std::max(max_syllables, w.syllables);
+
+    // Special-case: "halve"
+    if (max_number >= 2 && shard_lo <= 2 && 2 <= shard_hi) {
+        table.syl(0)[2] = 1;
+        table.key(0)[2].store(make_key(1, 0), std::memory_order_relaxed);
+    }
+
+    // Seeded values keep their base fraction count, to tell which entries the
+    // seed lowered; the seed ran through level max(syl5) and stopped there.
+    // The seed's own max_number is searched again: its root and "^" bounds come
+    // from pow and log, which can round a power landing exactly on it away.
+    const int seed_max = seed ? seed->max_number - 1 : -1;
+    vector<uint8_t> seed_frac_base;
+    int seed_levels = 0;
+    if (seed) {
+        seed_frac_base.assign(table.syl(0), table.syl(0) + seed_max + 1);
+        for (int u = 0; u < pemdas_count; ++u) {
+            const uint64_t* from = seed->keys + (size_t)u * (seed->max_number + 1);
+            uint8_t* syl = table.syl(u);
+            std::atomic<uint64_t>* key = table.key(u);
+            for (int n = 0; n <= seed_max; ++n) {
+                key[n].store(from[n], std::memory_order_relaxed);
+                syl[n] = (uint8_t)key_syllables(from[n]);
+            }
+        }
+        const uint8_t* syl_top = table.syl(pemdas_count - 1);
+        for (int n = 1; n <= seed_max; ++n) seed_levels = std::max<int>(seed_levels, syl_top[n]);
+    }
+
+    const int count = max_number + 1;
+    if (alts) {
+        const std::atomic<uint64_t>* key_top = table.key(pemdas_count - 1);
+        pool.parallel_for(0, count, 4096, [&](int b, int e, int) {
+            for (int n = b; n < e; ++n) alts->start(n, key_top[n].load(std::memory_order_relaxed));
+        });
+    }
+    const vector<int> spf = smallest_prime_factors(max_number);
+    vector<vector<int>> divisor_buffers(pool.size());
+    for (auto& d : divisor_buffers) d.reserve(256);
+
+    // open[u]: numbers of this shard whose level-u slot is still >= s, kept for the levels ops write
+    // to. A split whose outputs all miss it cannot change a slot and is skipped; the top level is
+    // also the shift kernels' live mask.
+    vector<OpenIndex> open(pemdas_count);
+    vector<int> result_levels;
+    for (const auto& op : binary_ops) result_levels.push_back(op.pemdas_result);
+    for (const auto& op : unary_ops) result_levels.push_back(op.pemdas_result);
+    result_levels.push_back(pemdas_count - 1);
+    std::sort(result_levels.begin(), result_levels.end());
+    result_levels.erase(std::unique(result_levels.begin(), result_levels.end()), result_levels.end());
+    for (int u : result_levels) open[u] = OpenIndex(count);
+    const uint64_t* open_top = open[pemdas_count - 1].raw_words();
+    // With alts: numbers whose list can still take a level-s word; a superset of the open top level,
+    // so it is the shift kernels' live mask instead.
+    OpenIndex alt_open(alts ? count : 0);
+    const uint64_t* scan_live = alts ? alt_open.raw_words() : open_top;
+
+    vector<vector<Frontier>> syllable_key;
+    syllable_key.emplace_back();
+    for (int u = 0; u < pemdas_count; ++u) syllable_key[0].emplace_back(count);
+
+    // novel[s][u]: seeded values that joined syllable_key[s][u] here, not in the seed.
+    vector<vector<Frontier>> novel;
+    auto add_novel_level = [&]() {
+        if (!seed) return;
+        novel.emplace_back();
+        for (int u = 0; u < pemdas_count; ++u) novel.back().emplace_back(seed_max + 1);
+    };
+    add_novel_level();
+
+    // Sharded: the level-2 members whose slot is plain and the numbers whose top
+    // level is done, over the whole range, as the shards last published them.
+    Frontier plain_two(shard ? count : 0);
+    vector<uint64_t> top_done(shard ? (size_t)(count + 63) / 64 : 0);
+
+    // Read for a left operand whose level-2 entry is already final.
+    auto left_plain = [&](int left) {
+        if (left >= shard_lo && left <= shard_hi) {
+            return key_is_plain(table.key(2)[left].load(std::memory_order_relaxed));
+        }
+        return plain_two.contains(left);
+    };
+
+    // Publish this shard's words of level s, wait for the other shards, take theirs.
+    auto exchange_level = [&](int s) {
+        ShardExchange& ex = *shard->exchange;
+        const int own_lo = shard_lo / 64, own_hi = shard_hi / 64 + 1;
+        const uint8_t* syl_top = table.syl(pemdas_count - 1);
+        pool.parallel_for(own_lo, own_hi, 256, [&](int wb, int we, int) {
+            for (int w = wb; w < we; ++w) {
+                for (int u = 0; u < pemdas_count; ++u) ex.words(s, u)[w] = syllable_key[s][u].word(w);
+                uint64_t plain = 0, done = 0;
+                for (uint64_t bits = syllable_key[s][2].word(w); bits; bits &= bits - 1) {
+                    const int n = w * 64 + __builtin_ctzll(bits);
+                    plain |= (uint64_t)key_is_plain(table.key(2)[n].load(std::memory_order_relaxed)) << (n & 63);
+                }
+                const int e = std::min(count, w * 64 + 64);
+                for (int n = w * 64; n < e; ++n) done |= (uint64_t)(syl_top[n] <= s) << (n & 63);
+                ex.words(s, ShardExchange::plain_two)[w] = plain;
+                ex.words(s, ShardExchange::top_done)[w] = done;
+            }
+        });
+        ex.wait();
+        pool.parallel_for(0, (count + 63) / 64, 1024, [&](int wb, int we, int) {
+            for (int w = wb; w < we; ++w) {
+                top_done[w] = ex.words(s, ShardExchange::top_done)[w];
+                if (w >= own_lo && w < own_hi) continue;
+                for (int u = 0; u < pemdas_count; ++u) syllable_key[s][u].store_word(w, ex.words(s, u)[w]);
+                plain_two.store_word(w, plain_two.word(w) | ex.words(s, ShardExchange::plain_two)[w]);
+            }
+        });
+    };
+
+    int min_missing = 1;
+    // With alts: the smallest number whose list is still open, and whether the table
+    // itself is done (the plain search would have stopped), so only lists take offers.
+    int min_alt = 1;
+    bool table_done = false;
+
+    struct alignas(64) WorkerCount { uint64_t offers{}; };
+    vector<WorkerCount> worker_counts(pool.size());
+
+    struct alignas(64) WorkerStats { OpStats counts; };
+    vector<WorkerStats> worker_stats(WithStats ? pool.size() : 0);
+
+    auto tally = [&](int worker, uint64_t OpStats::*field, uint64_t n = 1) {
+        if constexpr (WithStats) worker_stats[worker].counts.*field += n;
+    };
+
+    // Fold the per-worker counters of one (level, op, left_syl) split into `stats`.
+    auto close_split = [&](int s, int op_order, int left_syl, std::chrono::steady_clock::time_point t0) {
+        if constexpr (WithStats) {
+            SplitStats split{ s, op_order, left_syl, {} };
+            for (auto& w : worker_stats) {
+                split.counts += w.counts;
+                w.counts = {};
+            }
+            split.counts.seconds = seconds_since(t0);
+            stats->splits.push_back(split);
+        }
+    };
+
+    // Offer `key` (at s syllables) to levels first_u.. of `out`; lowered counts join the frontier.
+    auto commit = [&](int worker, int s, int out, int first_u, uint64_t key) {
+        ++worker_counts[worker].offers;
+        if (alts) alts->offer(out, key);
+        for (int u = first_u; u < pemdas_count; ++u) {
+            const Offer r = offer_key(table.key(u)[out], key);
+            tally(worker, &OpStats::cas_retries, r.retries);
+            if (!r.replaced) continue;
+            tally(worker, &OpStats::commits);
+            if (r.lowered) {
+                tally(worker, &OpStats::improvements);
+                table.syl(u)[out] = (uint8_t)s;
+                syllable_key[s][u].insert(out);
+                if (out <= seed_max) novel[s][u].insert(out);
+            } else if (out <= seed_max && syllable_key[s][u].contains(out)) {
+                // A tie can still change which pairs admit a member (fraction reads
+                // whether its left is plain), so the seed's pairs no longer cover it.
+                novel[s][u].insert(out);
+            }
+        }
+    };
+
+    if (report) report->base_fill_seconds = seconds_since(fill_start);
+
+    auto stopped = [&]() { return control && control->stop && control->stop->load(std::memory_order_relaxed); };
+
+    const int last_level = alts ? alt_last_level(max_syllables) : max_syllables;
+    for (int s = 1; s <= last_level; ++s) {
+        auto level_start = std::chrono::steady_clock::now();
+        uint64_t pruned_splits = 0;
+        if (stopped()) return false;
+        if (control && control->progress) control->progress(s, alts ? min_alt : min_missing);
+
+        syllable_key.emplace_back();
+        for (int u = 0; u < pemdas_count; ++u) syllable_key[s].emplace_back(count);
+        add_novel_level();
+        // Up to the seed's last level, pairs of seed members landing in the seed were all offered there.
+        const bool seen_level = s <= seed_levels;
+        // Lower output bound for the op kernels; in a shard, outputs are also cut at shard_hi.
+        // With alts the kernels scan from min_alt, and pairs under the plain bounds only reach lists.
+        const int out_floor = std::max(min_missing, shard_lo);
+        const int scan_floor = alts ? std::max(min_alt, shard_lo) : out_floor;
+        auto is_new = [&](int level, int u, int n) { return n > seed_max || novel[level][u].contains(n); };
+
+        // ---- Fill syllable_key[s][u] in parallel, one bitset word per 64 numbers ----
+        // Seeded entries the seed lowered to s joined the set in the seed's commits,
+        // below min_missing too, so a seeded run scans from 0.
+        const int first_word = seed ? 0 : out_floor / 64;
+        const int last_word = shard_hi / 64 + 1;
+        pool.parallel_for(first_word, last_word, 256, [&](int wb, int we, int) {
+            // Levels 1.. are non-increasing, so n joins level u exactly when levels 1..u
+            // all sit at s and the fraction level has not dropped below s.
+            const uint8_t* syl0 = table.syl(0);
+            const uint8_t* syl1 = table.syl(1);
+            for (int w = wb; w < we; ++w) {
+                const int b = seed ? w * 64 : std::max(min_missing, w * 64);
+                const int e = std::min(count, w * 64 + 64);
+                for (int u = 0; u < pemdas_count; ++u) {
+                    const uint8_t* sylu = table.syl(u);
+                    uint64_t bits = 0;
+                    for (int n = b; n < e; ++n) {
+                        bool in = (u == 0) ? syl0[n] == s : (syl0[n] >= s && syl1[n] == s && sylu[n] == s);
+                        if (seed) {
+                            const bool lowered =
+                                n <= seed_max && (u == 0 ? seed_frac_base[n] : table.original[n]) > s;
+                            in = (in && n >= min_missing) || (lowered && sylu[n] == s);
+                        }
+                        bits |= (uint64_t)in << (n & 63);
+                    }
+                    syllable_key[s][u].store_word(w, bits);
+                }
+            }
+        });
+        // Commits below min_missing still land ("/" outputs, lower levels), so open covers the whole shard.
+        pool.parallel_for(shard_lo / 64, last_word, 256, [&](int wb, int we, int) {
+            for (int w = wb; w < we; ++w) {
+                const int b = std::max(shard_lo, w * 64), e = std::min(shard_hi + 1, w * 64 + 64);
+                for (int u : result_levels) {
+                    if (table_done) break;
+                    const uint8_t* sylu = table.syl(u);
+                    uint64_t live = 0;
+                    if (e - b == 64) live = bytes_at_least(sylu + b, s);
+                    else for (int n = b; n < e; ++n) live |= (uint64_t)(sylu[n] >= s) << (n & 63);
+                    open[u].store_word(w, live);
+                }
+                if (!alts) continue;
+                uint64_t live = 0;
+                for (int n = b; n < e; ++n) live |= (uint64_t)(key_syllables(alts->last(n)) >= s) << (n & 63);
+                alt_open.store_word(w, live);
+            }
+        });
+        for (int u : result_levels) open[u].summarize();
+        if (alts) alt_open.summarize();
+        // Whether a level-s pair landing in [lo, hi] can still change a level-u slot or a list.
+        auto reachable = [&](int u, long long lo, long long hi) {
+            return (!table_done && open[u].any_in(lo, hi)) || (alts && alt_open.any_in(lo, hi));
+        };
+
+        // ---- Binary ops (parallel over left_list chunks), one instantiation per kind ----
+        for (int op_index = 0; op_index < (int)binary_ops.size(); ++op_index) {
+            const auto& op = binary_ops[op_index];
+            with_binary_op(op.kind, [&](auto kind) {
+                using Op = OpTraits<decltype(kind)::value>;
+                auto [min_left, max_left] = Op::first_extremes(scan_floor, max_number);
+                const double table_min_left = Op::first_extremes(out_floor, max_number).first;
+
+                for (int left_syl = 0; left_syl < s - op.syllables; ++left_syl) {
+                    if (stopped()) return;
+                    const auto& left_list = syllable_key[left_syl][op.pemdas_left].values();
+                    if (left_list.empty()) continue;
+
+                    int right_syl = s - op.syllables - left_syl;
+                    if (right_syl < 0) continue;
+                    const auto& right_list = syllable_key[right_syl][op.pemdas_right].values();
+                    if (right_list.empty()) continue;
+
+                    // Skip the split if nothing it can reach is still open at its result level.
+                    const OutRange lefts = { std::max<long long>(left_list.front(), (long long)std::ceil(min_left)),
+                                             std::min<long long>(left_list.back(), (long long)std::floor(max_left)) };
+                    const OutRange reach = Op::outputs(lefts, { right_list.front(), right_list.back() });
+                    if (lefts.lo > lefts.hi || !reachable(op.pemdas_result, reach.lo, reach.hi)) {
+                        ++pruned_splits;
+                        continue;
+                    }
+
+                    const auto split_start = std::chrono::steady_clock::now();
+                    static const vector<int> none;
+
+                    // "+" and "-" are sumsets: for each fixed operand v, shift the other
+                    // operand's bitset by v and keep the bits that can still improve.
+                    // Sparse slices are cheaper as a plain walk over the sorted list.
+                    if constexpr (Op::pairing == Pairing::Sumset) {
+                        constexpr bool fixed_left = Op::fixed_left;
+                        const int member_syl = fixed_left ? right_syl : left_syl;
+                        const int member_u = fixed_left ? op.pemdas_right : op.pemdas_left;
+                        const int fixed_syl = fixed_left ? left_syl : right_syl;
+                        const int fixed_u = fixed_left ? op.pemdas_left : op.pemdas_right;
+                        const Frontier& member_set = syllable_key[member_syl][member_u];
+                        const auto& member_list = fixed_left ? right_list : left_list;
+                        const auto& fixed_list = fixed_left ? left_list : right_list;
+                        const uint64_t* set_words = member_set.raw_words();
+                        const long long set_word_count = (long long)member_set.word_count();
+                        const auto& novel_members = seen_level ? novel[member_syl][member_u].values() : none;
+
+                        pool.parallel_for(0, (int)fixed_list.size(), pool.grain_for((int)fixed_list.size()),
+                                          [&](int bi, int ei, int worker) {
+                            for (int idx = bi; idx < ei; ++idx) {
+                                const int v = fixed_list[idx];
+                                if (v < min_left) continue;
+                                if (v > max_left) break;
+                                auto [delta, out_lo, out_hi] = Op::window(v, scan_floor, max_number);
+                                out_hi = std::min(out_hi, shard_hi);
+                                if (out_lo > out_hi) continue;
+                                // Outputs from table_lo up that are open in the table are committed there.
+                                const int table_lo = table_done || v < table_min_left
+                                                         ? max_number + 1 : Op::window(v, out_floor, max_number).lo;
+
+                                auto emit = [&](int out) {
+                                    tally(worker, &OpStats::pairs);
+                                    const uint64_t key =
+                                        make_key(s, op_rank(1 + op_index, left_syl, Op::left_of(v, out)));
+                                    if (!alts || (out >= table_lo && ((open_top[out >> 6] >> (out & 63)) & 1))) {
+                                        commit(worker, s, out, op.pemdas_result, key);
+                                    } else {
+                                        alts->offer(out, key);
+                                    }
+                                };
+
+                                // A seen fixed operand only pairs with novel members while both
+                                // operands stay inside the seed.
+                                if (seen_level && !is_new(fixed_syl, fixed_u, v)) {
+                                    const int seen_hi = (int)std::min<long long>(out_hi, seed_max - std::max(0LL, delta));
+                                    if (seen_hi >= out_lo) {
+                                        auto it = std::lower_bound(novel_members.begin(), novel_members.end(),
+                                                                   out_lo + delta);
+                                        for (; it != novel_members.end() && *it <= seen_hi + delta; ++it) {
+                                            const int out = (int)(*it - delta);
+                                            if ((scan_live[out >> 6] >> (out & 63)) & 1) emit(out);
+                                            else tally(worker, &OpStats::settled);
+                                        }
+                                        out_lo = seen_hi + 1;
+                                    }
+                                    if (out_lo > out_hi) continue;
+                                }
+
+                                auto first = std::lower_bound(member_list.begin(), member_list.end(), out_lo + delta);
+                                auto last = std::upper_bound(first, member_list.end(), out_hi + delta);
+                                if (last - first < shift_pairs_per_word * ((out_hi - out_lo) / 64 + 1)) {
+                                    for (auto it = first; it != last; ++it) {
+                                        const int out = (int)(*it - delta);
+                                        if ((scan_live[out >> 6] >> (out & 63)) & 1) emit(out);
+                                        else tally(worker, &OpStats::settled);
+                                    }
+                                } else {
+                                    tally(worker, &OpStats::shift_words, (uint64_t)((out_hi / 64) - (out_lo / 64) + 1));
+                                    for_each_shifted(set_words, set_word_count, scan_live, delta, out_lo, out_hi,
+                                                     emit);
+                                }
+                            }
+                        });
+                    } else {
+                        // "*" only needs right values in its (narrow) range, taken straight
+                        // from the bitset; "/" and "fraction" only need divisors of left_value.
+                        const Frontier& right_set = syllable_key[right_syl][op.pemdas_right];
+                        const auto& novel_rights = seen_level ? novel[right_syl][op.pemdas_right].values() : none;
+
+                        pool.parallel_for(0, (int)left_list.size(), pool.grain_for((int)left_list.size()),
+                                          [&](int bi, int ei, int worker) {
+                            auto try_pair = [&](int left_value, int right_value, bool to_table) {
+                                tally(worker, &OpStats::pairs);
+                                if constexpr (Op::naming_rule) {
+                                    if (fraction_rejected(table.auto_pass[left_value], table.zeroes[left_value],
+                                                          table.nonzero[left_value], left_plain(left_value),
+                                                          right_value, table.digits[right_value],
+                                                          table.nonzero[right_value])) {
+                                        tally(worker, &OpStats::fraction_rejects);
+                                        return;
+                                    }
+                                }
+
+                                const long long out_ll = Op::output(left_value, right_value);
+                                if (out_ll < 0 || out_ll > max_number) {
+                                    tally(worker, &OpStats::output_failures);
+                                    return;
+                                }
+                                if (out_ll < shard_lo || out_ll > shard_hi) return;
+                                const uint64_t key = make_key(s, op_rank(1 + op_index, left_syl, left_value));
+                                if (!to_table) {
+                                    alts->offer((int)out_ll, key);
+                                    return;
+                                }
+                                commit(worker, s, (int)out_ll, op.pemdas_result, key);
+                            };
+
+                            vector<int>& divisors = divisor_buffers[worker];
+
+                            for (int idx = bi; idx < ei; ++idx) {
+                                int left_value = left_list[idx];
+                                if (left_value < min_left) continue;
+                                if (left_value > max_left) break;
+
+                                auto [min_right, max_right] = Op::second_extremes(scan_floor, max_number, left_value);
+                                const OutRange reach = Op::outputs({ left_value, left_value },
+                                                                   { (long long)std::ceil(min_right),
+                                                                     (long long)std::floor(max_right) });
+                                if (reach.lo > reach.hi || !reachable(op.pemdas_result, reach.lo, reach.hi)) {
+                                    tally(worker, &OpStats::pruned);
+                                    continue;
+                                }
+                                // Pairs under the plain search's bounds go to the table too.
+                                const bool left_to_table = !table_done && left_value >= table_min_left;
+                                const double table_min_right =
+                                    alts ? Op::second_extremes(out_floor, max_number, left_value).first : min_right;
+                                auto to_table = [&](int right_value) {
+                                    return left_to_table && right_value >= table_min_right;
+                                };
+                                // A seen left only pairs with novel rights while the output stays in the seed.
+                                const bool left_seen = seen_level && !is_new(left_syl, op.pemdas_left, left_value);
+
+                                if constexpr (Op::pairing == Pairing::Multiples) {
+                                    int lo = (int)std::ceil(min_right);
+                                    if (left_seen) {
+                                        const int seen_hi = std::min((int)std::floor(max_right), seed_max / left_value);
+                                        auto it = std::lower_bound(novel_rights.begin(), novel_rights.end(), lo);
+                                        for (; it != novel_rights.end() && *it <= seen_hi; ++it) {
+                                            try_pair(left_value, *it, true);
+                                        }
+                                        lo = std::max(lo, seen_hi + 1);
+                                    }
+                                    const int hi = std::min((int)std::floor(max_right), shard_hi / left_value);
+                                    right_set.for_each_in(lo, hi, [&](int right_value) {
+                                        try_pair(left_value, right_value, to_table(right_value));
+                                    });
+                                } else if constexpr (Op::pairing == Pairing::Divisors) {
+                                    if (left_seen && novel_rights.empty()) continue;
+                                    list_divisors(left_value, spf, divisors);
+                                    for (int right_value : divisors) {
+                                        if (!right_set.contains(right_value)) continue;
+                                        if (left_seen && !is_new(right_syl, op.pemdas_right, right_value)) continue;
+                                        if (right_value < min_right || right_value > max_right) {
+                                            tally(worker, &OpStats::bound_rejects);
+                                            continue;
+                                        }
+                                        try_pair(left_value, right_value, to_table(right_value));
+                                    }
+                                } else {
+                                    for (int right_value : right_list) {
+                                        if (right_value < min_right || right_value > max_right) {
+                                            tally(worker, &OpStats::bound_rejects);
+                                            if (right_value > max_right) break;
+                                            continue;
+                                        }
+                                        if (left_seen && !is_new(right_syl, op.pemdas_right, right_value) &&
+                                            Op::output(left_value, right_value) <= seed_max) {
+                                            continue;
+                                        }
+                                        try_pair(left_value, right_value, to_table(right_value));
+                                    }
+                                }
+                            }
+                        });
+                    }
+                    close_split(s, 1 + op_index, left_syl, split_start);
+                }
+            });
+        }
+
+        // ---- Unary ops (parallel over input list chunks) ----
+        for (int op_index = 0; op_index < (int)unary_ops.size(); ++op_index) {
+            const auto& op = unary_ops[op_index];
+            if (s <= op.syllables || stopped()) continue;
+            with_unary_op(op.kind, [&](auto kind) {
+                using Op = OpTraits<decltype(kind)::value>;
+                auto [min_val, max_val] = Op::first_extremes(scan_floor, max_number);
+                const double table_min_val = Op::first_extremes(out_floor, max_number).first;
+                int in_syl = s - op.syllables;
+
+                const auto& in_list = syllable_key[in_syl][op.pemdas_input].values();
+                if (in_list.empty()) return;
+                const OutRange ins = { std::max<long long>(in_list.front(), (long long)std::ceil(min_val)),
+                                       std::min<long long>(in_list.back(), (long long)std::floor(max_val)) };
+                const OutRange reach = Op::outputs(ins);
+                if (ins.lo > ins.hi || !reachable(op.pemdas_result, reach.lo, reach.hi)) {
+                    ++pruned_splits;
+                    return;
+                }
+
+                const auto split_start = std::chrono::steady_clock::now();
+
+                pool.parallel_for(0, (int)in_list.size(), pool.grain_for((int)in_list.size()),
+                                  [&](int bi, int ei, int worker) {
+                    for (int idx = bi; idx < ei; ++idx) {
+                        int input_value = in_list[idx];
+                        tally(worker, &OpStats::pairs);
+                        if (input_value < min_val || input_value > max_val) {
+                            tally(worker, &OpStats::bound_rejects);
+                            if (input_value > max_val) break;
+                            continue;
+                        }
+
+                        const long long out_ll = Op::output(input_value);
+                        if (out_ll < 0 || out_ll > max_number) {
+                            tally(worker, &OpStats::output_failures);
+                            continue;
+                        }
+                        if (out_ll < shard_lo || out_ll > shard_hi) continue;
+                        if (seen_level && out_ll <= seed_max && !is_new(in_syl, op.pemdas_input, input_value)) continue;
+                        int out = (int)out_ll;
+
+                        const uint64_t key =
+                            make_key(s, op_rank(1 + (int)binary_ops.size() + op_index, in_syl, input_value));
+                        if (!table_done && input_value >= table_min_val) commit(worker, s, out, op.pemdas_result, key);
+                        else alts->offer(out, key);
+                    }
+                });
+                close_split(s, 1 + (int)binary_ops.size() + op_index, in_syl, split_start);
+            });
+        }
+
+        if (shard) exchange_level(s);
+
+        // Advance min_missing
+        auto top_settled = [&](int n) {
+            if (shard) return ((top_done[(size_t)n >> 6] >> (n & 63)) & 1) != 0;
+            return table.syl(pemdas_count - 1)[n] <= s;
+        };
+        while (min_missing <= leave_point && top_settled(min_missing)) min_missing++;
+        if (alts) {
+            while (min_alt <= leave_point && key_syllables(alts->last(min_alt)) <= s) min_alt++;
+        }
+        if (report) {
+            uint64_t offers = 0;
+            for (auto& c : worker_counts) offers += std::exchange(c.offers, 0);
+            report->levels.push_back({ s, seconds_since(level_start), offers, pruned_splits });
+        }
+        if (min_missing > leave_point) {
+            if (!alts || min_alt > leave_point) break;
+            table_done = true;
+        }
+    }
+    return !stopped();
+}
+
+static bool number_names_generator(NumberTable& table, int leave_point, int max_number, ThreadPool& pool,
+                                   const GeneratorControl* control = nullptr, GeneratorReport* report = nullptr,
+                                   GeneratorStats* stats = nullptr, const GeneratorSeed* seed = nullptr,
+                                   const GeneratorShard* shard = nullptr, AltTable* alts = nullptr) {
+    if (stats) {
+        return run_generator<true>(table, leave_point, max_number, pool, control, report, stats, seed, shard, alts);
+    }
+    return run_generator<false>(table, leave_point, max_number, pool, control, report, nullptr, seed, shard, alts);
+}
+
+// -------- persistent result table --------
+// File layout (native endianness):
+//   TableHeader
+//   uint8_t    syllables[pemdas_count][count]
+//   uint8_t    original[count]
+//   (zero padding to 8 bytes)
+//   uint64_t   keys[pemdas_count][count]    (packed slot words, see make_key)
+// i.e. the NumberTable arrays as they sit in memory.
+// Names and equations are rebuilt from the decoded keys on lookup.
+static constexpr char table_magic[8] = {'S','I','L','L','Y','T','B','L'};
+static constexpr uint32_t table_version = 5;
+
+struct TableHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pemdas;
+    uint64_t max_number;
+    uint64_t key_size;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "slot words are written to disk as-is");
+
+static size_t table_padding(uint64_t count) {
+    return (8 - (sizeof(TableHeader) + count * (pemdas_count + 1)) % 8) % 8;
+}
+
+static TableHeader table_header(uint64_t count) {
+    TableHeader h{};
+    std::memcpy(h.magic, table_magic, sizeof h.magic);
+    h.version = table_version;
+    h.pemdas = pemdas_count;
+    h.max_number = count - 1;
+    h.key_size = sizeof(uint64_t);
+    return h;
+}
+
+static void write_table(const string& path, const NumberTable& table) {
+    const uint64_t count = (uint64_t)table.count;
+    const auto& syllables = table.syllables;
+    const auto& original = table.original;
+    const auto& keys = table.keys;
+
+    const TableHeader h = table_header(count);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("cannot open " + path + " for writing");
+    static constexpr char pad[8] = {};
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    out.write(reinterpret_cast<const char*>(syllables.data()), (std::streamsize)syllables.size());
+    out.write(reinterpret_cast<const char*>(original.data()), (std::streamsize)original.size());
+    out.write(pad, (std::streamsize)table_padding(count));
+    out.write(reinterpret_cast<const char*>(keys.data()), (std::streamsize)(keys.size() * sizeof(uint64_t)));
+    if (!out) throw std::runtime_error("failed writing " + path);
+}
+
+Answer NumberTable::lookup(long long n) const {
+    auto derivs = [this](long long v, int u) { return decode_key(key(u)[v].load(std::memory_order_relaxed), v); };
+    const int u = pemdas_count - 1;
+    return { n, derivation_name(derivs, n, u), derivation_equation(derivs, n, u), syl(u)[n], original[n] };
+}
+
+// The root is asked for as value -1, so n further down the tree still reads its own word.
+Answer NumberTable::lookup(long long n, uint64_t top_key) const {
+    const int top = pemdas_count - 1;
+    const int syllables = key_syllables(top_key);
+    if (key_is_plain(top_key)) return { n, base_name(n, false), std::to_string(n), syllables, original[n] };
+    auto derivs = [&](long long v, int u) {
+        return v < 0 ? decode_key(top_key, n) : decode_key(key(u)[v].load(std::memory_order_relaxed), v);
+    };
+    return { n, derivation_name(derivs, -1, top), derivation_equation(derivs, -1, top), syllables, original[n] };
+}
+
+// Read-only view of a table file; nothing is parsed up front.
+class MappedTable {
+public:
+    explicit MappedTable(const string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open table " + path);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TableHeader)) {
+            ::close(fd);
+            throw std::runtime_error("table " + path + " is truncated");
+        }
+        size_ = (size_t)st.st_size;
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error("cannot mmap table " + path);
+        base_ = static_cast<const char*>(p);
+
+        std::memcpy(&header_, base_, sizeof header_);
+        if (std::memcmp(header_.magic, table_magic, sizeof table_magic) != 0 ||
+            header_.version != table_version || header_.pemdas != pemdas_count ||
+            header_.key_size != sizeof(uint64_t)) {
+            ::munmap(const_cast<char*>(base_), size_);
+            throw std::runtime_error("table " + path + " has an unsupported format");
+        }
+        // Values are ints, and a bound this small keeps the offsets below from wrapping.
+        if (header_.max_number >= (uint64_t)std::numeric_limits<int>::max()) {
+            ::munmap(const_cast<char*>(base_), size_);
+            throw std::runtime_error("table " + path + " is corrupt (max_number " +
+                                     std::to_string(header_.max_number) + ")");
+        }
+
+        const uint64_t count = header_.max_number + 1;
+        size_t off = sizeof(TableHeader);
+        syllables_ = reinterpret_cast<const uint8_t*>(base_ + off);   off += count * pemdas_count;
+        original_ = reinterpret_cast<const uint8_t*>(base_ + off);    off += count + table_padding(count);
+        keys_ = reinterpret_cast<const uint64_t*>(base_ + off);       off += count * pemdas_count * sizeof(uint64_t);
+        if (off > size_) {
+            ::munmap(const_cast<char*>(base_), size_);
+            throw std::runtime_error("table " + path + " is truncated");
+        }
+    }
+    ~MappedTable() { ::munmap(const_cast<char*>(base_), size_); }
+    MappedTable(const MappedTable&) = delete;
+    MappedTable& operator=(const MappedTable&) = delete;
+
+    long long max_number() const { return (long long)header_.max_number; }
+    const uint64_t* keys() const { return keys_; }
+
+    Answer lookup(long long n) const {
+        const size_t count = header_.max_number + 1;
+        auto derivs = [this, count](long long v, int u) { return decode_key(keys_[u * count + v], v); };
+        const int u = pemdas_count - 1;
+        return { n, derivation_name(derivs, n, u), derivation_equation(derivs, n, u),
+                 syllables_[u * count + n], original_[n] };
+    }
+
+private:
+    const char* base_{};
+    size_t size_{};
+    TableHeader header_{};
+    const uint8_t* syllables_{};
+    const uint8_t* original_{};
+    const uint64_t* keys_{};
+};
+
+// -------- targeted single-number search --------
+// Answers one number n without filling all of [0, n]. Values up to `core` come
+// from an existing table's slot words ([pemdas_count][core + 1], as in
+// NumberTable::keys or a table file); values above it are searched backward
+// from n through the same grammar: roots for "²", "³" and "^", divisor pairs
+// for "*", small multiples for "/" and "fraction", and for n itself "+" and "-"
+// against cheap core values (whose large partner may itself be a large power
+// plus or minus a core value) and large powers. Entries are slot words like
+// the table's, so ties break the same way.
+// Each large value is searched only as deep as its syllable budget (what its
+// parent can still afford) and is searched again if a later parent affords more.
+// Slot words only ever go down, so the winning derivations never form a cycle.
+// The search is deliberately partial (see Scope and the limits below, and a
+// value met again on its own search path is cut there), so the result is not
+// guaranteed to match the full table.
+class TargetedSearch {
+public:
+    // Core operands of "+"/"-" are tried up to this many syllables; dearer ones
+    // rarely win, since their large partner would then have to be very cheap.
+    static constexpr int sum_core_syllables = 4;
+    // ... and at most this many per op, cheapest first: each one is a large value
+    // searched on its own, so this bounds the work of one query.
+    static constexpr int sum_core_operands = 128;
+    // Powers paired with the target in "+"/"-" cost at most this much.
+    static constexpr int sum_power_syllables = 5;
+    // Largest right operand tried for "/" and "fraction" above the core.
+    static constexpr int max_denominator = 20;
+    // No operand above this is searched ("/" numerators are the largest), so
+    // every one fits the left operand field of a slot word.
+    static constexpr long long operand_max = 10 * SyllableSolver::lookup_max;
+    static_assert(operand_max <= (long long)rank_left_mask, "operands fit a slot word");
+
+    TargetedSearch(const uint64_t* core_keys, int core, long long target)
+        : core_keys_(core_keys), core_(core), target_(target) {
+        // Core operands for "+" (right at level 5) and "-" (right at level 4), by syllables.
+        for (int r = 1; r <= core_; ++r) {
+            bucket(plus_rights_, key_syllables(slot(r, 5))).push_back(r);
+            bucket(minus_rights_, key_syllables(slot(r, 4))).push_back(r);
+        }
+
+        // Cheap powers above the core are the usual large term of a sum; with "-"
+        // they can lie above n, by up to n.
+        const long long power_max = 2 * target;
+        for (long long b = 2; b * b <= power_max && b <= core_; ++b) {
+            const int base_syl = key_syllables(slot(b, 2));
+            long long p = b * b;
+            for (int k = 2; p <= power_max && k <= core_; ++k, p *= b) {
+                const int syl = k <= 3 ? base_syl + 1 : k == 4 ? base_syl + 2 : base_syl + 2 + key_syllables(slot(k, 0));
+                if (p > core_ && syl <= sum_power_syllables) powers_.push_back(p);
+            }
+        }
+        std::sort(powers_.begin(), powers_.end());
+        powers_.erase(std::unique(powers_.begin(), powers_.end()), powers_.end());
+    }
+
+    Answer answer() {
+        if (target_ > core_) expand(target_, plain_base(target_).n_syl, Scope::Target);
+        auto derivs = [this](long long v, int u) { return decode_key(slot(v, u), v); };
+        const int u = pemdas_count - 1;
+        return { target_, derivation_name(derivs, target_, u), derivation_equation(derivs, target_, u),
+                 key_syllables(slot(target_, u)), plain_base(target_).n_syl, target_ > core_ };
+    }
+
+private:
+    // How far a large value is searched. Factors only decomposes into smaller
+    // values (roots, "*", "^"), so the search always bottoms out; Multiples adds
+    // "/" and "fraction" with numerators up to n (searched as Factors); Sums adds
+    // "+" and "-" of a large power and a core value, and numerators above n;
+    // Target adds "+" and "-" against cheap core values (whose large partner gets
+    // Sums) and any large power (whose partner gets Multiples). Below the target,
+    // operands of roots, "*" and "^" get Factors: the search stays near n.
+    enum class Scope : uint8_t { Factors, Multiples, Sums, Target };
+
+    struct Node {
+        uint64_t key[pemdas_count];
+        int budget;     // every derivation up to this many syllables has been offered
+        Scope scope;    // ... among those this scope looks at
+        bool done;
+        vector<uint64_t> factors;   // prime factors, kept for later expansions and the values below
+    };
+
+    static vector<int>& bucket(vector<vector<int>>& by_syl, int s) {
+        if ((int)by_syl.size() <= s) by_syl.resize(s + 1);
+        return by_syl[s];
+    }
+
+    uint64_t slot(long long v, int u) const {
+        if (v <= core_) return core_keys_[(size_t)u * (core_ + 1) + v];
+        return nodes_.at(v).key[u];
+    }
+
+    // Slot word of (v, u) if it fits in `budget` syllables, searching v first if
+    // needed; false when it does not fit or v is on the current search path.
+    // `primes`, if given, holds every prime factor v can have above 100.
+    bool entry(long long v, int u, int budget, Scope scope, uint64_t& key, const vector<uint64_t>* primes = nullptr) {
+        if (budget < 1) return false;
+        if (v > core_) {
+            // Past 19³ every form takes at least 3 syllables (ops cost 1+, one-syllable
+            // numbers stop at nineteen), so smaller budgets need no search.
+            if (v > 6859 && budget < 3) return false;
+            auto it = nodes_.find(v);
+            const bool stale = it == nodes_.end() ||
+                               (it->second.done && (it->second.budget < budget || it->second.scope < scope));
+            const Node& node = stale ? expand(v, budget, scope, primes) : it->second;
+            if (!node.done) return false;
+            key = node.key[u];
+        } else {
+            key = slot(v, u);
+        }
+        return key_syllables(key) <= budget;
+    }
+
+    // Prime factors of v, trying `primes` (those of a value v divides, is a root
+    // of or a small multiple of) before prime_factors takes what is left.
+    static void factor_over(long long v, const vector<uint64_t>* primes, vector<uint64_t>& out) {
+        if (!primes) return prime_factors((uint64_t)v, out);
+        uint64_t rest = (uint64_t)v;
+        vector<uint64_t> found;
+        for (size_t i = 0; i < primes->size(); ++i) {
+            const uint64_t p = (*primes)[i];
+            if (i > 0 && p == (*primes)[i - 1]) continue;
+            for (; rest % p == 0; rest /= p) found.push_back(p);
+        }
+        prime_factors(rest, out);
+        out.insert(out.end(), found.begin(), found.end());
+        std::sort(out.begin(), out.end());
+    }
+
+    // Divisors of v (prime factors `factors`) as (small, large) pairs with 2 <= small <= large.
+    static void divisor_pairs(long long v, const vector<uint64_t>& factors, vector<std::pair<long long,long long>>& out) {
+        vector<long long> divisors{1};
+        for (size_t i = 0; i < factors.size();) {
+            const long long p = (long long)factors[i];
+            const size_t existing = divisors.size();
+            for (; i < factors.size() && (long long)factors[i] == p; ++i) {
+                const size_t from = divisors.size() - existing;
+                for (size_t k = from; k < from + existing; ++k) divisors.push_back(divisors[k] * p);
+            }
+        }
+        out.clear();
+        for (long long d : divisors) {
+            if (d >= 2 && d <= v / d) out.push_back({ d, v / d });
+        }
+    }
+
+    // Integer k-th root of v, or 0 when v is not a k-th power.
+    static long long exact_root(long long v, int k) {
+        long long r = std::llround(std::pow((double)v, 1.0 / k));
+        for (long long c = std::max(1LL, r - 1); c <= r + 1; ++c) {
+            long long p = 1;
+            int i = 0;
+            for (; i < k && p <= v / c; ++i) p *= c;
+            if (i == k && p == v) return c;
+        }
+        return 0;
+    }
+
+    Node& expand(long long v, int budget, Scope scope, const vector<uint64_t>* primes = nullptr) {
+        auto [it, fresh] = nodes_.try_emplace(v);
+        Node& node = it->second;
+        if (fresh) {
+            const BaseOut base = plain_base(v);
+            node.key[0] = make_key(base.frac_syl, 0);
+            for (int u = 1; u < pemdas_count; ++u) node.key[u] = make_key(base.n_syl, 0);
+            factor_over(v, primes, node.factors);
+        }
+        const vector<uint64_t>* own = &node.factors;   // node references stay valid as nodes_ grows
+        // Operands of roots, "*" and "^" (see Scope).
+        const Scope inner = scope == Scope::Target ? Scope::Multiples : Scope::Factors;
+        node.budget = std::max(node.budget, budget);
+        node.scope = std::max(node.scope, scope);
+        node.done = false;
+        budget = node.budget;
+        scope = node.scope;
+
+        // Syllables an op_order derivation landing at level `first_u` may spend and
+        // still win: a tie only wins against a lower-ranked op (see make_key).
+        auto limit = [&](int first_u, int op_order) {
+            const uint64_t cur = node.key[first_u];
+            const int cur_order = (int)((rank_mask - (cur & rank_mask)) >> rank_op_shift);
+            return std::min(budget, key_syllables(cur) - (cur_order > op_order ? 1 : 0));
+        };
+        auto offer = [&](int syllables, int op_order, int left_syl, long long left, int first_u) {
+            const uint64_t key = make_key(syllables, op_rank(op_order, left_syl, left));
+            for (int u = first_u; u < pemdas_count; ++u) node.key[u] = std::min(node.key[u], key);
+        };
+
+        for (int k = 0; k < (int)unary_ops.size(); ++k) {
+            const auto& op = unary_ops[k];
+            const long long root = exact_root(v, op.value);
+            uint64_t in;
+            const int room = limit(op.pemdas_result, 1 + (int)binary_ops.size() + k) - op.syllables;
+            if (root < 1 || !entry(root, op.pemdas_input, room, inner, in, own)) {
+                continue;
+            }
+            offer(key_syllables(in) + op.syllables, 1 + (int)binary_ops.size() + k, key_syllables(in), root,
+                  op.pemdas_result);
+        }
+
+        // The cheaper side to look up goes first: a core operand (one read), else
+        // `right`. The other side is then searched only as deep as what is left.
+        // `primes` as for entry, for both operands.
+        auto try_pair = [&](int op_index, long long left, long long right, Scope left_scope, Scope right_scope,
+                            const vector<uint64_t>* primes) {
+            if (left > operand_max) return;
+            const auto& op = binary_ops[op_index];
+            const int room = limit(op.pemdas_result, 1 + op_index) - op.syllables;
+            uint64_t lk, rk;
+            if (left <= core_ && right > core_) {
+                if (!entry(left, op.pemdas_left, room - 1, left_scope, lk)) return;
+                if (!entry(right, op.pemdas_right, room - key_syllables(lk), right_scope, rk, primes)) return;
+            } else {
+                if (!entry(right, op.pemdas_right, room - 1, right_scope, rk, primes)) return;
+                if (!entry(left, op.pemdas_left, room - key_syllables(rk), left_scope, lk, primes)) return;
+            }
+            if (op.kind == OpKind::Fraction) {
+                const BaseOut l = plain_base(left);
+                const BaseOut r = plain_base(right);
+                const bool auto_pass = (left % 100 < 20 && left % 100 > 0) || l.zeroes < 1 || l.digits < 3;
+                if (fraction_rejected(auto_pass, stored_zeroes(l.zeroes), l.digits - l.zeroes,
+                                      key_is_plain(slot(left, 2)), (int)right, r.digits, r.digits - r.zeroes)) {
+                    return;
+                }
+            }
+            offer(key_syllables(lk) + op.syllables + key_syllables(rk), 1 + op_index, key_syllables(lk), left,
+                  op.pemdas_result);
+        };
+
+        vector<std::pair<long long,long long>> pairs;
+        for (int op_index = 0; op_index < (int)binary_ops.size(); ++op_index) {
+            const auto& op = binary_ops[op_index];
+            if (limit(op.pemdas_result, 1 + op_index) < op.syllables + 2) continue;
+            if (op.kind == OpKind::Multiply) {
+                if (pairs.empty()) divisor_pairs(v, *own, pairs);
+                for (auto [small, large] : pairs) try_pair(op_index, small, large, inner, inner, own);
+            } else if (op.kind == OpKind::Divide || op.kind == OpKind::Fraction) {
+                if (scope == Scope::Factors) continue;
+                // Numerators above n only for n and the large terms of its sums.
+                const long long numerator_max = scope >= Scope::Sums ? operand_max : target_;
+                for (int right = 2; right <= max_denominator && v * right <= numerator_max; ++right) {
+                    try_pair(op_index, v * right, right, Scope::Factors, Scope::Factors, own);
+                }
+            } else if (op.kind == OpKind::Power) {
+                for (int right = 5; right < (int)superscripts.size(); ++right) {
+                    const long long left = exact_root(v, right);
+                    if (left >= 2) try_pair(op_index, left, right, inner, Scope::Factors, own);
+                }
+            }
+        }
+
+        // "+" and "-": for the target, walk the cheapest core operands while the other
+        // side could still make a tie, then pair with every large power; for a Sums
+        // value, only with the powers a core value away.
+        for (int op_index = 0; scope >= Scope::Sums && op_index < (int)binary_ops.size(); ++op_index) {
+            const auto& op = binary_ops[op_index];
+            if (op.kind != OpKind::Add && op.kind != OpKind::Subtract) continue;
+            const bool plus = op.kind == OpKind::Add;
+            auto try_sum = [&](long long left, long long right, Scope left_scope, Scope right_scope) {
+                if (right < 1 || (plus && (left < right || left < 6))) return;
+                try_pair(op_index, left, right, left_scope, right_scope, nullptr);
+            };
+
+            if (scope == Scope::Sums) {
+                // v = p + r or v = p - r with r in the core.
+                const long long lo = plus ? v - core_ : v + 1, hi = plus ? v - 1 : v + core_;
+                for (auto it = std::lower_bound(powers_.begin(), powers_.end(), lo);
+                     it != powers_.end() && *it <= hi; ++it) {
+                    try_sum(*it, plus ? v - *it : *it - v, Scope::Factors, Scope::Factors);
+                }
+                continue;
+            }
+
+            const auto& rights = plus ? plus_rights_ : minus_rights_;
+            const int last_syl = std::min((int)rights.size() - 1, sum_core_syllables);
+            int tried = 0;
+            for (int right_syl = 1; right_syl <= last_syl && tried < sum_core_operands; ++right_syl) {
+                if (right_syl + op.syllables + 1 > limit(op.pemdas_result, 1 + op_index)) break;
+                for (size_t i = 0; i < rights[right_syl].size() && tried < sum_core_operands; ++i, ++tried) {
+                    const int right = rights[right_syl][i];
+                    try_sum(plus ? v - right : v + right, right, Scope::Sums, Scope::Factors);
+                }
+            }
+
+            for (long long p : powers_) {
+                if (plus) {
+                    try_sum(p, v - p, Scope::Factors, Scope::Multiples);
+                    try_sum(v - p, p, Scope::Multiples, Scope::Factors);
+                } else {
+                    try_sum(p, p - v, Scope::Factors, Scope::Multiples);
+                    try_sum(v + p, p, Scope::Multiples, Scope::Factors);
+                }
+            }
+        }
+
+        node.done = true;
+        return node;
+    }
+
+    const uint64_t* core_keys_;
+    int core_;
+    long long target_;
+    vector<vector<int>> plus_rights_;
+    vector<vector<int>> minus_rights_;
+    vector<long long> powers_;
+    std::unordered_map<long long, Node> nodes_;
+};
+
+// -------- library API (silly.h) --------
+// A State is one finished table, built here or mapped from a file, and is never
+// written again; builds make a new one and swap the pointer, so lookups only
+// hold state_mutex long enough to copy it.
+static_assert(SyllableSolver::top_max == AltTable::top_limit, "silly.h and AltTable disagree on --top");
+
+struct SyllableSolver::Impl {
+    struct State {
+        NumberTable table;
+        std::unique_ptr<MappedTable> mapped;
+        long long max_number = -1;
+        const uint64_t* keys = nullptr;   // [pemdas_count][max_number + 1], either source
+        AltTable alts;                    // k() == 0 unless built with top > 1
+    };
+
+    explicit Impl(int threads) : pool(threads > 0 ? threads : default_threads()) {}
+
+    std::shared_ptr<const State> current() const {
+        std::lock_guard<std::mutex> g(state_mutex);
+        return state;
+    }
+
+    void publish(std::shared_ptr<const State> next, GeneratorStats* next_stats) {
+        std::lock_guard<std::mutex> g(state_mutex);
+        state = std::move(next);
+        if (next_stats) stats = std::move(*next_stats);
+    }
+
+    bool run(int max_number, const BuildOptions& options, const GeneratorSeed* seed) {
+        if (max_number < 0 || max_number > build_max) {
+            throw std::out_of_range("tables are built up to " + std::to_string(build_max));
+        }
+        if (options.top < 1 || options.top > top_max) {
+            throw std::out_of_range("top is 1.." + std::to_string(top_max));
+        }
+        if (options.top > 1 && seed) throw std::invalid_argument("top forms need a fresh build, not extend");
+        auto next = std::make_shared<State>();
+        if (options.top > 1) next->alts.reset(max_number + 1, options.top);
+        const GeneratorControl control{ options.progress, options.stop };
+        GeneratorStats next_stats;
+        if (!number_names_generator(next->table, max_number, max_number, pool, &control, nullptr,
+                                    options.stats ? &next_stats : nullptr, seed, nullptr,
+                                    options.top > 1 ? &next->alts : nullptr)) {
+            return false;
+        }
+        next->max_number = max_number;
+        next->keys = next->table.raw_keys();
+        publish(std::move(next), options.stats ? &next_stats : nullptr);
+        return true;
+    }
+
+    ThreadPool pool;
+    std::mutex build_mutex;   // one build at a time; they share the pool
+    mutable std::mutex state_mutex;
+    std::shared_ptr<const State> state;
+    GeneratorStats stats;
+};
+
+SyllableSolver::SyllableSolver(int threads) : impl_(std::make_unique<Impl>(threads)) {}
+SyllableSolver::~SyllableSolver() = default;
+
+bool SyllableSolver::build(int max_number, const BuildOptions& options) {
+    std::lock_guard<std::mutex> g(impl_->build_mutex);
+    return impl_->run(max_number, options, nullptr);
+}
+
+bool SyllableSolver::extend(int max_number, const BuildOptions& options) {
+    std::lock_guard<std::mutex> g(impl_->build_mutex);
+    const auto old = impl_->current();
+    if (!old) return impl_->run(max_number, options, nullptr);
+    if (old->max_number > max_number) {
+        throw std::invalid_argument("the table already covers 0.." + std::to_string(old->max_number));
+    }
+    const GeneratorSeed seed{ (int)old->max_number, old->keys };
+    return impl_->run(max_number, options, &seed);
+}
+
+void SyllableSolver::load(const string& path) {
+    auto next = std::make_shared<Impl::State>();
+    next->mapped = std::make_unique<MappedTable>(path);
+    next->max_number = next->mapped->max_number();
+    next->keys = next->mapped->keys();
+    std::lock_guard<std::mutex> g(impl_->build_mutex);
+    impl_->publish(std::move(next), nullptr);
+}
+
+void SyllableSolver::save(const string& path) const {
+    const auto state = impl_->current();
+    if (!state || state->mapped) throw std::logic_error("only a built table can be saved");
+    write_table(path, state->table);
+}
+
+long long SyllableSolver::max_number() const {
+    const auto state = impl_->current();
+    return state ? state->max_number : -1;
+}
+
+SyllableAnswer SyllableSolver::lookup(long long n) const {
+    if (n < 0 || n > lookup_max) throw std::out_of_range("only numbers up to 999,999,999,999 can be named");
+    const auto state = impl_->current();
+    if (!state) throw std::logic_error("no table built or loaded");
+    if (n > state->max_number) return TargetedSearch(state->keys, (int)state->max_number, n).answer();
+    return state->mapped ? state->mapped->lookup(n) : state->table.lookup(n);
+}
+
+vector<SyllableAnswer> SyllableSolver::lookup_top(long long n) const {
+    const auto state = impl_->current();
+    if (!state || state->alts.k() == 0 || n < 0 || n > state->max_number) return { lookup(n) };
+    // Regrouped products and sums ("3 * 41 * 813" both ways) read the same; the first stands for both.
+    vector<SyllableAnswer> out;
+    for (int i = 0; i < state->alts.k() && state->alts.word(n, i) != AltTable::empty; ++i) {
+        SyllableAnswer a = state->table.lookup(n, state->alts.word(n, i));
+        auto same = [&](const SyllableAnswer& b) { return b.equation == a.equation; };
+        if (std::none_of(out.begin(), out.end(), same)) out.push_back(std::move(a));
+    }
+    return out;
+}
+
+void SyllableSolver::print_stats(std::ostream& os, bool json) const {
+    std::lock_guard<std::mutex> g(impl_->state_mutex);
+    if (json) print_stats_json(impl_->stats, os);
+    else print_stats_text(impl_->stats, os);
+}
+
+#if defined(SILLY_BENCH)
+
+// silly_bench: times number_names_generator over a max_number x threads matrix
+// and prints one JSON document. Each run happens in a forked child so its peak
+// RSS is its own.
+static vector<int> parse_list(const string& text) {
+    vector<int> out;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == string::npos) comma = text.size();
+        out.push_back(std::stoi(text.substr(pos, comma - pos)));
+        pos = comma + 1;
+    }
+    return out;
+}
+
+// User-space hardware counters for this process and the threads it starts
+// afterwards (inherit), so they must be opened before the pool. Events the
+// kernel or the machine refuses (VMs often have no PMU) read as -1.
+class HardwareCounters {
+public:
+    HardwareCounters() {
+        static constexpr uint64_t configs[count] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        };
+        for (int i = 0; i < count; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof attr;
+            attr.type = i == l1d_read_misses ? PERF_TYPE_HW_CACHE : PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds_[i] = (int)::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+    }
+    ~HardwareCounters() {
+        for (int fd : fds_) if (fd >= 0) ::close(fd);
+    }
+
+    void start() {
+        for (int fd : fds_) if (fd >= 0) ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    void stop() {
+        for (int fd : fds_) if (fd >= 0) ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    long long value(int i) const {
+        uint64_t v = 0;
+        if (fds_[i] < 0 || ::read(fds_[i], &v, sizeof v) != (ssize_t)sizeof v) return -1;
+        return (long long)v;
+    }
+
+    static constexpr int cycles = 0, instructions = 1, cache_references = 2, cache_misses = 3, l1d_read_misses = 4;
+    static constexpr int count = 5;
+
+private:
+    int fds_[count];
+};
+
+// -------- --check: reference search --------
+// The original search, single-threaded and with nothing but sorted vectors: every
+// op by its id, every pair in its operand bounds (min_missing included, so lower
+// levels agree byte for byte), the syllables of every value at every level.
+static std::pair<double, double> reference_first_extremes(const string& id, int min_missing, int max_number) {
+    if (id == "²") return { std::pow((double)min_missing, 1.0 / 2.0), std::pow((double)max_number, 1.0 / 2.0) };
+    if (id == "³") return { std::pow((double)min_missing, 1.0 / 3.0), std::pow((double)max_number, 1.0 / 3.0) };
+    if (id == "+") return { 6.0, (double)max_number - 1.0 };
+    if (id == "*") return { 2.0, std::pow((double)max_number, 0.5) };
+    if (id == "-") return { (double)min_missing + 1.0, (double)max_number };
+    if (id == "/" || id == "fraction") return { (double)min_missing * 2.0, (double)max_number };
+    if (id == "^") return { 2.0, std::pow((double)max_number, 0.2) };
+    return { 0.0, 0.0 };
+}
+
+static std::pair<double, double> reference_second_extremes(const string& id, int min_missing, int max_number,
+                                                           int left) {
+    if (id == "+") return { 1.0, (double)std::min(left, max_number - left) };
+    if (id == "*") {
+        return { (double)std::max(left, (int)std::ceil((double)min_missing / left)), (double)max_number / left };
+    }
+    if (id == "-") return { 1.0, (double)(left - min_missing) };
+    if (id == "/" || id == "fraction") return { 2.0, (double)left / 2.0 };
+    if (id == "^") return { 5.0, std::log((double)max_number) / std::log((double)left) };
+    return { 0.0, 0.0 };
+}
+
+// -1 when the op has no output for the pair.
+static long long reference_output(const string& id, long long left, long long right) {
+    if (id == "²") return left * left;
+    if (id == "³") return left * left * left;
+    if (id == "+") return left + right;
+    if (id == "*") return left * right;
+    if (id == "-") return left - right;
+    if (id == "/" || id == "fraction") return left % right == 0 ? left / right : -1;
+    if (id == "^") {
+        long long out = 1;
+        for (long long i = 0; i < right; ++i) out *= left;
+        return out;
+    }
+    return -1;
+}
+
+// What the reference search paired from: its frontier sets [s][u] and which
+// level-2 slots stayed plain, as the last level left them.
+struct ReferenceSets {
+    vector<vector<vector<int>>> sets;
+    vector<bool> plain_two;
+};
+
+// syl[u][n] for 0 <= n <= max_number; with `out`, also the sets behind them.
+static vector<vector<uint8_t>> reference_syllables(int max_number, ReferenceSets* out = nullptr) {
+    const int count = max_number + 1;
+    vector<vector<uint8_t>> syl(pemdas_count, vector<uint8_t>(count));
+    vector<BaseOut> base(count);
+    vector<bool> plain_two(count, true);
+    int max_syllables = 0;
+    for (int n = 0; n <= max_number; ++n) {
+        base[n] = plain_base(n);
+        syl[0][n] = (uint8_t)base[n].frac_syl;
+        for (int u = 1; u < pemdas_count; ++u) syl[u][n] = (uint8_t)base[n].n_syl;
+        max_syllables = std::max(max_syllables, base[n].n_syl);
+    }
+    if (max_number >= 2) syl[0][2] = 1;
+
+    vector<vector<vector<int>>> sets(1, vector<vector<int>>(pemdas_count));
+    int min_missing = 1;
+    for (int s = 1; s <= max_syllables; ++s) {
+        sets.emplace_back(pemdas_count);
+        for (int n = min_missing; n <= max_number; ++n) {
+            for (int u = 0; u < pemdas_count; ++u) {
+                if (syl[u][n] < s) break;
+                if (syl[u][n] == s) sets[s][u].push_back(n);
+                else if (u > 0) break;
+            }
+        }
+        // Level s only reads the sets of earlier levels, so its own may grow unsorted.
+        auto commit = [&](long long out, int result) {
+            if (out < 0 || out > max_number) return;
+            for (int u = result; u < pemdas_count; ++u) {
+                if (syl[u][out] < s) continue;
+                if (u == 2) plain_two[out] = false;
+                if (syl[u][out] > s) {
+                    syl[u][out] = (uint8_t)s;
+                    sets[s][u].push_back((int)out);
+                }
+            }
+        };
+
+        for (const BinaryOp& op : binary_ops) {
+            const auto [min_left, max_left] = reference_first_extremes(op.id, min_missing, max_number);
+            for (int left_syl = 1; left_syl < s - op.syllables; ++left_syl) {
+                const int right_syl = s - op.syllables - left_syl;
+                for (int left : sets[left_syl][op.pemdas_left]) {
+                    if (left < min_left) continue;
+                    if (left > max_left) break;
+                    const auto [min_right, max_right] = reference_second_extremes(op.id, min_missing, max_number, left);
+                    for (int right : sets[right_syl][op.pemdas_right]) {
+                        if (right < min_right) continue;
+                        if (right > max_right) break;
+                        if (op.id == "^" && right >= (int)superscripts.size()) continue;
+                        if (op.id == "fraction") {
+                            const BaseOut& l = base[left];
+                            const BaseOut& r = base[right];
+                            const bool auto_pass = (left % 100 < 20 && left % 100 > 0) || l.zeroes < 1 || l.digits < 3;
+                            if (fraction_rejected(auto_pass, stored_zeroes(l.zeroes), l.digits - l.zeroes,
+                                                  plain_two[left], right, r.digits, r.digits - r.zeroes)) {
+                                continue;
+                            }
+                        }
+                        commit(reference_output(op.id, left, right), op.pemdas_result);
+                    }
+                }
+            }
+        }
+        for (const UnaryOp& op : unary_ops) {
+            if (s <= op.syllables) continue;
+            const auto [min_in, max_in] = reference_first_extremes(op.id, min_missing, max_number);
+            for (int in : sets[s - op.syllables][op.pemdas_input]) {
+                if (in < min_in) continue;
+                if (in > max_in) break;
+                commit(reference_output(op.id, in, 0), op.pemdas_result);
+            }
+        }
+        for (auto& set : sets[s]) std::sort(set.begin(), set.end());
+
+        while (min_missing <= max_number && syl[pemdas_count - 1][min_missing] <= s) min_missing++;
+        if (min_missing > max_number) break;
+    }
+    if (out) {
+        out->sets = std::move(sets);
+        out->plain_two = std::move(plain_two);
+    }
+    return syl;
+}
+
+// Syllables of the k best distinct forms of every number, best first: every pair
+// of the reference's sets within the op bounds at min_missing 1 (a --top search
+// cuts nothing for being settled) up to alt_last_level, one per (op kind, left).
+static vector<vector<int>> reference_top(int max_number, int k) {
+    ReferenceSets ref;
+    reference_syllables(max_number, &ref);
+    const auto& sets = ref.sets;
+    vector<BaseOut> base(max_number + 1);
+    int max_syllables = 0;
+    for (int n = 0; n <= max_number; ++n) {
+        base[n] = plain_base(n);
+        max_syllables = std::max(max_syllables, base[n].n_syl);
+    }
+    const int last_level = alt_last_level(max_syllables);
+
+    // forms[n]: (op kind, left) -> fewest syllables; the plain number is (-1, n).
+    vector<std::map<std::pair<int, long long>, int>> forms(max_number + 1);
+    auto offer = [&](long long out, int kind, long long left, int syllables) {
+        if (out < 1 || out > max_number) return;
+        auto [it, added] = forms[out].try_emplace({ kind, left }, syllables);
+        if (!added) it->second = std::min(it->second, syllables);
+    };
+    for (int n = 1; n <= max_number; ++n) offer(n, -1, n, base[n].n_syl);
+
+    const int levels = (int)sets.size();
+    for (const BinaryOp& op : binary_ops) {
+        const auto [min_left, max_left] = reference_first_extremes(op.id, 1, max_number);
+        for (int left_syl = 1; left_syl < levels; ++left_syl) {
+            for (int right_syl = 1; right_syl < levels && left_syl + op.syllables + right_syl <= last_level;
+                 ++right_syl) {
+                for (int left : sets[left_syl][op.pemdas_left]) {
+                    if (left < min_left) continue;
+                    if (left > max_left) break;
+                    const auto [min_right, max_right] = reference_second_extremes(op.id, 1, max_number, left);
+                    for (int right : sets[right_syl][op.pemdas_right]) {
+                        if (right < min_right) continue;
+                        if (right > max_right) break;
+                        if (op.id == "^" && right >= (int)superscripts.size()) continue;
+                        if (op.id == "fraction") {
+                            const BaseOut& l = base[left];
+                            const BaseOut& r = base[right];
+                            const bool auto_pass = (left % 100 < 20 && left % 100 > 0) || l.zeroes < 1 || l.digits < 3;
+                            if (fraction_rejected(auto_pass, stored_zeroes(l.zeroes), l.digits - l.zeroes,
+                                                  ref.plain_two[left], right, r.digits, r.digits - r.zeroes)) {
+                                continue;
+                            }
+                        }
+                        offer(reference_output(op.id, left, right), (int)op.kind, left,
+                              left_syl + op.syllables + right_syl);
+                    }
+                }
+            }
+        }
+    }
+    for (const UnaryOp& op : unary_ops) {
+        const auto [min_in, max_in] = reference_first_extremes(op.id, 1, max_number);
+        for (int in_syl = 1; in_syl < levels && in_syl + op.syllables <= last_level; ++in_syl) {
+            for (int in : sets[in_syl][op.pemdas_input]) {
+                if (in < min_in) continue;
+                if (in > max_in) break;
+                offer(reference_output(op.id, in, 0), (int)op.kind, in, in_syl + op.syllables);
+            }
+        }
+    }
+
+    vector<vector<int>> top(max_number + 1);
+    for (int n = 1; n <= max_number; ++n) {
+        for (const auto& form : forms[n]) top[n].push_back(form.second);
+        std::sort(top[n].begin(), top[n].end());
+        if ((int)top[n].size() > k) top[n].resize(k);
+    }
+    return top;
+}
+
+// Counts the slots where table disagrees with the reference at the levels
+// [first_u, pemdas_count) and prints the first few.
+static long long count_mismatches(const vector<vector<uint8_t>>& reference, const NumberTable& table, int first_u,
+                                  const string& variant) {
+    long long mismatches = 0;
+    for (int u = first_u; u < pemdas_count; ++u) {
+        for (size_t n = 0; n < reference[u].size(); ++n) {
+            if (table.syl(u)[n] == reference[u][n]) continue;
+            if (++mismatches <= 5) {
+                std::cerr << variant << ": " << n << " at level " << u << " has " << (int)table.syl(u)[n]
+                          << " syllables, the reference " << (int)reference[u][n] << "\n";
+            }
+        }
+    }
+    return mismatches;
+}
+
+// --check: the fast path against the reference at every thread count, then
+// grown from half the range (top level only: the full search's operand bounds
+// skip some shorter lower-level forms a grown table keeps) and with --top forms kept,
+// whose whole lists are held to reference_top over the first top_check_max numbers.
+// Prints the "check" member and returns the total mismatch count.
+static long long check_run(int max_number, const vector<int>& thread_counts) {
+    auto start = std::chrono::steady_clock::now();
+    const auto reference = reference_syllables(max_number);
+    std::cout << "  \"check\": {\"max_number\": " << max_number << ", \"reference_seconds\": " << seconds_since(start)
+              << ", \"variants\": [";
+
+    long long total = 0;
+    bool first = true;
+    auto report = [&](const string& variant, double seconds, long long mismatches) {
+        std::cout << (first ? "" : ",") << "\n    {\"variant\": \"" << variant << "\", \"seconds\": " << seconds
+                  << ", \"mismatches\": " << mismatches << "}" << std::flush;
+        first = false;
+        total += mismatches;
+    };
+
+    for (int threads : thread_counts) {
+        ThreadPool pool(threads);
+        NumberTable table;
+        start = std::chrono::steady_clock::now();
+        number_names_generator(table, max_number, max_number, pool);
+        const double seconds = seconds_since(start);
+        const string variant = "threads=" + std::to_string(threads);
+        report(variant, seconds, count_mismatches(reference, table, 0, variant));
+    }
+
+    ThreadPool pool(thread_counts.back());
+    NumberTable half, grown;
+    start = std::chrono::steady_clock::now();
+    number_names_generator(half, max_number / 2, max_number / 2, pool);
+    const GeneratorSeed seed{ max_number / 2, half.raw_keys() };
+    number_names_generator(grown, max_number, max_number, pool, nullptr, nullptr, nullptr, &seed);
+    double seconds = seconds_since(start);
+    report("extend", seconds, count_mismatches(reference, grown, pemdas_count - 1, "extend"));
+
+    NumberTable table;
+    AltTable alts;
+    alts.reset(max_number + 1, 3);
+    start = std::chrono::steady_clock::now();
+    number_names_generator(table, max_number, max_number, pool, nullptr, nullptr, nullptr, nullptr, nullptr, &alts);
+    seconds = seconds_since(start);
+    long long mismatches = count_mismatches(reference, table, 0, "top=3");
+    // The best of the kept forms is the table's own.
+    for (int n = 0; n <= max_number; ++n) {
+        if (key_syllables(alts.word(n, 0)) == reference[pemdas_count - 1][n]) continue;
+        if (++mismatches <= 5) std::cerr << "top=3: first form of " << n << " is not the best\n";
+    }
+    report("top=3", seconds, mismatches);
+
+    // Enumerating every pair is quadratic, so the lists are checked over small ranges;
+    // the smallest ones run out of forms, so they also cover lists that stay short.
+    static constexpr int top_check_max = 2000;
+    seconds = 0;
+    mismatches = 0;
+    for (int list_max : { 10, 100, top_check_max }) {
+        list_max = std::min(max_number, list_max);
+        const auto expected = reference_top(list_max, alts.k());
+        NumberTable small;
+        AltTable small_alts;
+        small_alts.reset(list_max + 1, alts.k());
+        start = std::chrono::steady_clock::now();
+        number_names_generator(small, list_max, list_max, pool, nullptr, nullptr, nullptr, nullptr, nullptr,
+                               &small_alts);
+        seconds += seconds_since(start);
+        for (int n = 1; n <= list_max; ++n) {
+            vector<int> got;
+            for (int i = 0; i < small_alts.k() && small_alts.word(n, i) != AltTable::empty; ++i) {
+                got.push_back(key_syllables(small_alts.word(n, i)));
+            }
+            if (got == expected[n]) continue;
+            if (++mismatches <= 5) {
+                std::cerr << "top=3 lists of 0.." << list_max << ": " << n << " has";
+                for (int g : got) std::cerr << " " << g;
+                std::cerr << ", the reference";
+                for (int e : expected[n]) std::cerr << " " << e;
+                std::cerr << "\n";
+            }
+        }
+    }
+    report("top=3 lists", seconds, mismatches);
+    std::cout << "\n  ]}";
+    return total;
+}
+
+static double bench_run(int max_number, int threads) {
+    HardwareCounters counters;
+    ThreadPool pool(threads);
+    NumberTable table;
+    GeneratorReport report;
+    auto start = std::chrono::steady_clock::now();
+    counters.start();
+    number_names_generator(table, max_number, max_number, pool, nullptr, &report);
+    counters.stop();
+    const double wall = seconds_since(start);
+
+    struct rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+
+    const uint64_t candidates = report.candidates();
+    std::cout << "    {\"max_number\": " << max_number
+              << ", \"threads\": " << threads
+              << ", \"wall_seconds\": " << wall
+              << ", \"base_fill_seconds\": " << report.base_fill_seconds
+              << ", \"peak_rss_kb\": " << usage.ru_maxrss
+              << ", \"candidates\": " << candidates
+              << ", \"candidates_per_second\": " << (wall > 0 ? candidates / wall : 0.0);
+
+    // Unavailable counters print as null.
+    auto count = [](long long v) { return v < 0 ? string("null") : std::to_string(v); };
+    const long long cycles = counters.value(HardwareCounters::cycles);
+    const long long instructions = counters.value(HardwareCounters::instructions);
+    std::cout << ",\n     \"counters\": {\"cycles\": " << count(cycles) << ", \"instructions\": " << count(instructions)
+              << ", \"ipc\": ";
+    if (cycles > 0 && instructions >= 0) std::cout << (double)instructions / cycles;
+    else std::cout << "null";
+    std::cout << ", \"cache_references\": " << count(counters.value(HardwareCounters::cache_references))
+              << ", \"cache_misses\": " << count(counters.value(HardwareCounters::cache_misses))
+              << ", \"l1d_read_misses\": " << count(counters.value(HardwareCounters::l1d_read_misses)) << "}"
+              << ",\n     \"levels\": [";
+    for (size_t i = 0; i < report.levels.size(); ++i) {
+        const auto& l = report.levels[i];
+        std::cout << (i ? ", " : "") << "{\"syllables\": " << l.syllables << ", \"seconds\": " << l.seconds
+                  << ", \"candidates\": " << l.candidates << ", \"pruned_splits\": " << l.pruned << "}";
+    }
+    std::cout << "]}";
+    return wall;
+}
 
-    for (int i = 2; i < argc; ++i) {
+// Numbers near the top of the lookup range, each searched back over one core
+// table as the CLI does past 2,000,000. A fixed list, so runs compare.
+static const long long lookup_numbers[] = {
+    534439589175, 154335349840, 205380810795, 741520749048,
+    334107653877, 194650323160, 561423994714, 999999999999,
+};
+
+// Times SyllableSolver::lookup for the first `count` lookup_numbers over a
+// core of `core` and prints them as the "lookups" object; returns the slowest.
+static double lookup_run(int core, int count, int threads) {
+    SyllableSolver solver(threads);
+    auto start = std::chrono::steady_clock::now();
+    solver.build(core);
+    const double build_seconds = seconds_since(start);
+
+    vector<double> seconds;
+    std::cout << "  \"lookups\": {\"core\": " << core << ", \"build_seconds\": " << build_seconds << ", \"numbers\": [";
+    for (int i = 0; i < count; ++i) {
+        start = std::chrono::steady_clock::now();
+        const SyllableAnswer a = solver.lookup(lookup_numbers[i]);
+        seconds.push_back(seconds_since(start));
+        std::cout << (i ? "," : "") << "\n    {\"number\": " << a.number << ", \"seconds\": " << seconds.back()
+                  << ", \"syllables\": " << a.syllables << ", \"original\": " << a.original << "}" << std::flush;
+    }
+    std::sort(seconds.begin(), seconds.end());
+    const double median = seconds.empty() ? 0.0 : seconds[seconds.size() / 2];
+    const double slowest = seconds.empty() ? 0.0 : seconds.back();
+    std::cout << "],\n    \"median_seconds\": " << median << ", \"max_seconds\": " << slowest << "}";
+    return slowest;
+}
+
+// Wall seconds by (max_number, threads) from an earlier silly_bench document.
+static std::map<std::pair<int, int>, double> read_baseline(const string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot read " + path);
+    std::map<std::pair<int, int>, double> walls;
+    string line;
+    while (std::getline(in, line)) {
+        int max_number = 0, threads = 0;
+        double wall = 0;
+        if (std::sscanf(line.c_str(), " {\"max_number\": %d, \"threads\": %d, \"wall_seconds\": %lf", &max_number,
+                        &threads, &wall) == 3) {
+            walls[{ max_number, threads }] = wall;
+        }
+        // The slowest lookup, under the key (-1, 0).
+        const size_t at = line.find("\"max_seconds\": ");
+        if (at != string::npos && std::sscanf(line.c_str() + at, "\"max_seconds\": %lf", &wall) == 1) {
+            walls[{ -1, 0 }] = wall;
+        }
+    }
+    return walls;
+}
+
+int main(int argc, char** argv) {
+    vector<int> sizes = {10000, 100000, 1000000, 2000000};
+    vector<int> thread_counts = {1};
+    if (default_threads() > 1) thread_counts.push_back(default_threads());
+    int check_max = -1;
+    int lookup_count = (int)(sizeof lookup_numbers / sizeof lookup_numbers[0]);
+    bool sizes_given = false, lookups_given = false;
+    string baseline_path;
+    double tolerance = 1.25;
+
+    for (int i = 1; i < argc; ++i) {
         string arg = argv[i];
-        if (arg == "--quiet") quiet = true;
-        else if (arg == "--show" && i + 1 < argc) {
-            show = argv[++i];
-        } else {
-            std::cerr << "Unknown argument: " << arg << "\n";
-            print_usage();
+        try {
+            if (arg == "--sizes" && i + 1 < argc) sizes = parse_list(argv[++i]), sizes_given = true;
+            else if (arg == "--threads" && i + 1 < argc) thread_counts = parse_list(argv[++i]);
+            else if (arg == "--check" && i + 1 < argc) check_max = std::stoi(argv[++i]);
+            else if (arg == "--lookups" && i + 1 < argc) lookup_count = std::stoi(argv[++i]), lookups_given = true;
+            else if (arg == "--baseline" && i + 1 < argc) baseline_path = argv[++i];
+            else if (arg == "--tolerance" && i + 1 < argc) tolerance = std::stod(argv[++i]);
+            else throw std::invalid_argument(arg);
+            if (check_max > SyllableSolver::build_max || tolerance < 1.0) throw std::invalid_argument(arg);
+            if (lookup_count < 0 || lookup_count > (int)(sizeof lookup_numbers / sizeof lookup_numbers[0])) {
+                throw std::invalid_argument(arg);
+            }
+            for (int threads : thread_counts) if (threads < 1) throw std::invalid_argument(arg);
+        } catch (const std::exception&) {
+            std::cerr << "Usage: silly_bench [--sizes 10000,100000,...] [--threads 1,8,...]\n"
+                         "                   [--check 20000] [--lookups 0..8] [--baseline bench.json [--tolerance 1.25]]\n";
+            return 1;
+        }
+    }
+    // --check alone checks; the timed runs need --sizes or --lookups then.
+    if (check_max >= 0 && !sizes_given) sizes.clear();
+    if (check_max >= 0 && !lookups_given) lookup_count = 0;
+
+    std::map<std::pair<int, int>, double> baseline;
+    if (!baseline_path.empty()) {
+        try {
+            baseline = read_baseline(baseline_path);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
             return 1;
         }
     }
 
-    number_names_generator(n, n, !quiet);
+    bool failed = false;
+    std::cout << "{\n";
+    if (check_max >= 0) {
+        const long long mismatches = check_run(check_max, thread_counts);
+        if (mismatches) std::cerr << mismatches << " mismatches against the reference search\n";
+        failed = mismatches != 0;
+        std::cout << ",\n";
+    }
+
+    std::cout << "  \"runs\": [\n";
+    bool first = true;
+    for (int max_number : sizes) {
+        for (int threads : thread_counts) {
+            if (max_number < 0) continue;
+            std::cout << (first ? "" : ",\n") << std::flush;
+            first = false;
+
+            // The child hands its wall time back for the --baseline gate.
+            int wall_pipe[2];
+            if (::pipe(wall_pipe) < 0) {
+                std::cerr << "cannot start run max_number=" << max_number << " threads=" << threads << "\n";
+                return 1;
+            }
+            pid_t child = ::fork();
+            if (child == 0) {
+                ::close(wall_pipe[0]);
+                const double wall = bench_run(max_number, threads);
+                std::cout << std::flush;
+                if (::write(wall_pipe[1], &wall, sizeof wall) != (ssize_t)sizeof wall) ::_exit(1);
+                ::_exit(0);
+            }
+            ::close(wall_pipe[1]);
+            double wall = 0;
+            const bool got_wall = child > 0 && ::read(wall_pipe[0], &wall, sizeof wall) == (ssize_t)sizeof wall;
+            ::close(wall_pipe[0]);
+            int status = 0;
+            if (child < 0 || ::waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+                !got_wall) {
+                std::cerr << "run max_number=" << max_number << " threads=" << threads << " failed\n";
+                return 1;
+            }
+
+            const auto base = baseline.find({ max_number, threads });
+            if (base != baseline.end() && wall > base->second * tolerance) {
+                std::cerr << "max_number=" << max_number << " threads=" << threads << " took " << wall
+                          << " s, over " << tolerance << " x the baseline " << base->second << " s\n";
+                failed = true;
+            }
+        }
+    }
+    std::cout << "\n  ]";
+
+    // Targeted lookups near 1e12, over the CLI's default core.
+    if (lookup_count > 0) {
+        std::cout << ",\n";
+        const double slowest = lookup_run(65536, lookup_count, thread_counts.back());
+        const auto base = baseline.find({ -1, 0 });
+        if (base != baseline.end() && slowest > base->second * tolerance) {
+            std::cerr << "slowest lookup took " << slowest << " s, over " << tolerance << " x the baseline "
+                      << base->second << " s\n";
+            failed = true;
+        }
+    }
+    std::cout << "\n}\n";
+    return failed ? 1 : 0;
+}
+
+#elif !defined(SILLY_LIBRARY)
+
+static void print_usage() {
+    std::cout <<
+        "Usage: saynum <number> [--quiet] [--show name|equation|both|all] [--table <file>] [--threads N]\n"
+        "              [--targeted [--core N]] [--top K] [--stats | --stats=json]\n"
+        "       saynum --build-table <max> [--table <file>] [--extend <old table>] [--quiet] [--threads N]\n"
+        "              [--shards N] [--stats | --stats=json]\n"
+        "Example: ./saynum 27 --quiet --show both\n"
+        "--targeted searches back from the number over a small table (--core, default 65536,\n"
+        "or the --table file) instead of building [0, number]; fast, but may miss the best form,\n"
+        "so its answers are marked \"searched\".\n"
+        "Numbers past 2,000,000 (up to 999,999,999,999) always use --targeted; near 1e12 that takes\n"
+        "up to about 1.5 s per number.\n"
+        "--top K (up to 8) lists the K best distinct forms, ranked, from one fresh build (fewer\n"
+        "where [0, number] has fewer).\n"
+        "--extend grows an existing table to <max>, searching only what the old one could not have seen.\n"
+        "--shards splits the build over N processes (sharing --threads), each holding the slot words of\n"
+        "one slice of [0, max] (48 bytes a number) but still about 35 bytes a number of all of [0, max];\n"
+        "tables up to N x 2,000,000, at most 100,000,000 (about 3.5 GB a shard), can be built this way.\n"
+        "       saynum --batch [<file> | -] [--format tsv|jsonl] [--table <file> | --top K] [--threads N]\n"
+        "       saynum --range <a>..<b> [--format tsv|jsonl] [--table <file> | --top K] [--threads N]\n"
+        "--batch reads one <n> or <a>..<b> per line (stdin by default), builds the table once up to\n"
+        "the largest number asked for and writes one row per number (per form, with a rank, for --top).\n";
+}
 
-    const auto& e = number_names[n];
-    const string& name = e.names.back();
-    const string& eq = e.equations.back();
-    int best_syl = e.syllables.back();
-    int orig_syl = e.original;
+static void print_progress(int syllables, long long min_missing) {
+    std::cout << "searching " << syllables << " syllables, at " << min_missing << "\n";
+}
 
+// rank > 0 numbers one of several --top forms.
+static bool print_answer(const Answer& a, const string& show, int rank = 0) {
+    const string prefix = rank > 0 ? std::to_string(rank) + ". " : "";
     auto diff_suffix = [&]() -> string {
-        return " (from " + std::to_string(orig_syl) + " to " + std::to_string(best_syl) + " syllies)";
+        return " (from " + std::to_string(a.original) + " to " + std::to_string(a.syllables) + " syllies" +
+               (a.searched ? ", searched: may not be the shortest)" : ")");
     };
 
     if (show == "name") {
-        std::cout << n << " -> " << name << diff_suffix() << "\n";
+        std::cout << prefix << a.number << " -> " << a.name << diff_suffix() << "\n";
     } else if (show == "equation") {
-        std::cout << n << " -> " << eq << diff_suffix() << "\n";
+        std::cout << prefix << a.number << " -> " << a.equation << diff_suffix() << "\n";
     } else if (show == "both") {
-        std::cout << n << " -> " << name << " (" << eq << ")" << diff_suffix() << "\n";
+        std::cout << prefix << a.number << " -> " << a.name << " (" << a.equation << ")" << diff_suffix() << "\n";
     } else if (show == "all") {
-        std::cout << "number: " << n << "\n";
-        std::cout << "name: " << name << "\n";
-        std::cout << "equation: " << eq << "\n";
-        std::cout << "syllables: " << best_syl << "\n";
-        std::cout << "original syllables: " << orig_syl << "\n";
+        std::cout << "number: " << a.number << "\n";
+        if (rank > 0) std::cout << "rank: " << rank << "\n";
+        std::cout << "name: " << a.name << "\n";
+        std::cout << "equation: " << a.equation << "\n";
+        std::cout << "syllables: " << a.syllables << "\n";
+        std::cout << "original syllables: " << a.original << "\n";
+        if (a.searched) std::cout << "searched: yes (may not be the shortest)\n";
     } else {
         std::cerr << "Invalid --show option.\n";
+        return false;
+    }
+    return true;
+}
+
+// Largest number a fresh build covers densely; past it only --targeted answers.
+static constexpr long long full_build_max = SyllableSolver::build_max;
+// Spelled-out names stop at "billion".
+static constexpr long long max_named = SyllableSolver::lookup_max;
+// Largest --shards build. Every shard holds about 35 bytes per number of the
+// whole range (see GeneratorShard), so this keeps each near 3.5 GB.
+static constexpr long long sharded_build_max = 100000000;
+
+static bool parse_count(const char* text, long long& out) {
+    try {
+        out = std::stoll(text);
+    } catch (...) {
+        std::cerr << "Invalid number.\n";
+        return false;
+    }
+    if (out < 0) {
+        std::cerr << "Only non-negative integers are supported.\n";
+        return false;
+    }
+    return true;
+}
+
+// -------- batch and range queries --------
+// One query line: "n" or "a..b" (inclusive), both ends in [0, max_named].
+struct QueryRange {
+    long long lo;
+    long long hi;
+};
+
+static bool parse_query(const string& text, QueryRange& q) {
+    auto number = [](const string& t, long long& out) {
+        if (t.empty() || t.size() > 12 || t.find_first_not_of("0123456789") != string::npos) return false;
+        out = std::stoll(t);
+        return out <= max_named;
+    };
+    const size_t dots = text.find("..");
+    if (dots == string::npos) {
+        if (!number(text, q.lo)) return false;
+        q.hi = q.lo;
+        return true;
+    }
+    return number(text.substr(0, dots), q.lo) && number(text.substr(dots + 2), q.hi) && q.lo <= q.hi;
+}
+
+// Query lines from `in`; blank lines and "#" comments are skipped, bad lines
+// reported. False if any line was bad.
+static bool read_queries(std::istream& in, vector<QueryRange>& out) {
+    bool ok = true;
+    string line;
+    for (int line_no = 1; std::getline(in, line); ++line_no) {
+        const size_t b = line.find_first_not_of(" \t\r");
+        if (b == string::npos || line[b] == '#') continue;
+        const string text = line.substr(b, line.find_last_not_of(" \t\r") + 1 - b);
+        QueryRange q{};
+        if (parse_query(text, q)) {
+            out.push_back(q);
+        } else {
+            std::cerr << "line " << line_no << ": expected <n> or <a>..<b> up to 999,999,999,999: " << text << "\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Answer rows as TSV or JSON lines, gathered in one buffer and written to stdout
+// in large blocks. Ranked rows (--top) lead with their rank.
+class RowWriter {
+public:
+    RowWriter(bool json, bool ranked) : json_(json), ranked_(ranked) {
+        buf_.reserve(block_size + 4096);
+        if (!json_) buf_ += string(ranked_ ? "rank\t" : "") + "number\tsyllables\toriginal\tname\tequation\n";
+    }
+    ~RowWriter() { flush(); }
+    RowWriter(const RowWriter&) = delete;
+    RowWriter& operator=(const RowWriter&) = delete;
+
+    void write(const Answer& a, int rank = 0) {
+        if (json_) {
+            buf_ += ranked_ ? "{\"rank\": " + std::to_string(rank) + ", " : "{";
+            buf_ += "\"number\": " + std::to_string(a.number) + ", \"syllables\": " + std::to_string(a.syllables) +
+                    ", \"original\": " + std::to_string(a.original) + ", \"name\": ";
+            append_json_string(a.name);
+            buf_ += ", \"equation\": ";
+            append_json_string(a.equation);
+            buf_ += a.searched ? ", \"searched\": true}\n" : "}\n";
+        } else {
+            if (ranked_) buf_ += std::to_string(rank) + '\t';
+            buf_ += std::to_string(a.number) + '\t' + std::to_string(a.syllables) + '\t' +
+                    std::to_string(a.original) + '\t' + a.name + '\t' + a.equation + '\n';
+        }
+        if (buf_.size() >= block_size) flush();
+    }
+
+    void flush() {
+        std::fwrite(buf_.data(), 1, buf_.size(), stdout);
+        buf_.clear();
+    }
+
+private:
+    static constexpr size_t block_size = 1 << 20;
+
+    void append_json_string(const string& text) {
+        buf_ += '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                buf_ += '\\';
+                buf_ += c;
+            } else if ((unsigned char)c < 0x20) {
+                char esc[8];
+                std::snprintf(esc, sizeof esc, "\\u%04x", (unsigned)c);
+                buf_ += esc;
+            } else {
+                buf_ += c;
+            }
+        }
+        buf_ += '"';
+    }
+
+    string buf_;
+    bool json_;
+    bool ranked_;
+};
+
+// Answers every query from one table: the --table file, or a single build up to
+// the largest query (at most full_build_max). Larger numbers are searched back
+// from over that table, as with --targeted.
+static void run_queries(const vector<QueryRange>& queries, SyllableSolver& solver, const string& table_path,
+                        bool json, bool stats, int top) {
+    long long largest = 0;
+    for (const auto& q : queries) largest = std::max(largest, q.hi);
+
+    if (!table_path.empty()) {
+        solver.load(table_path);
+    } else {
+        SyllableSolver::BuildOptions options;
+        options.stats = stats;
+        options.top = top;
+        solver.build((int)std::min(largest, full_build_max), options);
+    }
+
+    RowWriter out(json, top > 1);
+    for (const auto& q : queries) {
+        for (long long n = q.lo; n <= q.hi; ++n) {
+            if (top == 1) {
+                out.write(solver.lookup(n));
+                continue;
+            }
+            int rank = 0;
+            for (const auto& a : solver.lookup_top(n)) out.write(a, ++rank);
+        }
+    }
+}
+
+// A sharded build's slice [lo, hi] of every array, written in place into a table
+// file that already has its header and full size (see build_sharded_table).
+static void write_table_slice(const string& path, const NumberTable& table, int lo, int hi) {
+    const size_t count = (size_t)table.count;
+    const size_t len = (size_t)(hi - lo + 1);
+    const size_t keys_at = sizeof(TableHeader) + count * (pemdas_count + 1) + table_padding(count);
+
+    int fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0) throw std::runtime_error("cannot open " + path + " for writing");
+    auto put = [&](const void* data, size_t bytes, size_t offset) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes > 0) {
+            const ssize_t w = ::pwrite(fd, p, bytes, (off_t)offset);
+            if (w <= 0) {
+                ::close(fd);
+                throw std::runtime_error("failed writing " + path);
+            }
+            p += w;
+            bytes -= (size_t)w;
+            offset += (size_t)w;
+        }
+    };
+    for (int u = 0; u < pemdas_count; ++u) {
+        put(table.syl(u) + lo, len, sizeof(TableHeader) + u * count + lo);
+        put(table.key(u) + lo, len * sizeof(uint64_t), keys_at + (u * count + lo) * sizeof(uint64_t));
+    }
+    put(table.original.data() + lo, len, sizeof(TableHeader) + pemdas_count * count + lo);
+    ::close(fd);
+}
+
+// --shards: `shards` forked processes build the table together, each committing
+// one 64-aligned slice of [0, n] and meeting the others in a ShardExchange after
+// every level, then writing its slice of the file in place. The parent writes
+// the header, waits, and stops the rest if any shard fails.
+static bool build_sharded_table(const string& path, int n, int shards, int threads, bool quiet) {
+    const uint64_t count = (uint64_t)n + 1;
+    const int words = n / 64 + 1;
+    shards = std::min(shards, words);
+    {
+        const TableHeader h = table_header(count);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof h);
+        if (!out) throw std::runtime_error("cannot open " + path + " for writing");
+    }
+    const size_t file_size = sizeof(TableHeader) + count * (pemdas_count + 1) + table_padding(count) +
+                             count * pemdas_count * sizeof(uint64_t);
+    if (::truncate(path.c_str(), (off_t)file_size) != 0) throw std::runtime_error("cannot size " + path);
+
+    ShardExchange exchange(shards, n);
+    vector<pid_t> children;
+    auto stop_all = [&]() {
+        for (pid_t c : children) if (c > 0) ::kill(c, SIGKILL);
+    };
+    std::cout << std::flush;
+    const pid_t parent = ::getpid();
+    for (int i = 0; i < shards; ++i) {
+        const int lo = (int)((long long)words * i / shards * 64);
+        const int hi = (int)std::min<long long>((long long)words * (i + 1) / shards * 64 - 1, n);
+        const pid_t child = ::fork();
+        if (child == 0) {
+            // A shard outliving the parent would wait at the exchange barrier for
+            // ever, so it dies with it; the parent may have gone before the prctl.
+            if (::prctl(PR_SET_PDEATHSIG, SIGKILL) != 0 || ::getppid() != parent) ::_exit(1);
+            int rc = 0;
+            try {
+                ThreadPool pool(threads);
+                NumberTable table;
+                GeneratorControl control;
+                if (!quiet && i == 0) control.progress = print_progress;
+                const GeneratorShard shard{ lo, hi, &exchange };
+                number_names_generator(table, n, n, pool, &control, nullptr, nullptr, nullptr, &shard);
+                write_table_slice(path, table, lo, hi);
+            } catch (const std::exception& ex) {
+                std::cerr << "shard " << i << ": " << ex.what() << "\n";
+                rc = 1;
+            }
+            std::cout << std::flush;
+            ::_exit(rc);
+        }
+        if (child < 0) {
+            stop_all();
+            while (::wait(nullptr) > 0) {}
+            ::unlink(path.c_str());
+            throw std::runtime_error("cannot start shard " + std::to_string(i));
+        }
+        children.push_back(child);
+    }
+
+    bool ok = true;
+    for (int running = shards; running > 0; --running) {
+        int status = 0;
+        const pid_t child = ::waitpid(-1, &status, 0);
+        if (child < 0) break;
+        std::replace(children.begin(), children.end(), child, (pid_t)0);
+        if ((!WIFEXITED(status) || WEXITSTATUS(status) != 0) && ok) {
+            ok = false;
+            stop_all();
+        }
+    }
+    if (!ok) ::unlink(path.c_str());
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage();
+        return 1;
+    }
+
+    bool quiet = false;
+    string show = "both";
+    string table_path;
+    string extend_path;
+    bool build_table = false;
+    int threads = default_threads();
+    string stats_format;
+    bool targeted = false;
+    long long core_max = 65536;
+    long long n_ll = 0;
+    int shards = 1;
+    bool batch = false;
+    string batch_path;
+    vector<QueryRange> queries;
+    bool json = false;
+    int top = 1;
+
+    int first_opt = 2;
+    if (string(argv[1]) == "--batch") {
+        batch = true;
+        if (argc > 2 && string(argv[2]).compare(0, 2, "--") != 0) {
+            batch_path = argv[2];
+            first_opt = 3;
+        }
+    } else if (string(argv[1]) == "--range") {
+        QueryRange q{};
+        if (argc < 3 || !parse_query(argv[2], q)) {
+            std::cerr << "--range needs <a>..<b> with a <= b <= 999,999,999,999.\n";
+            return 1;
+        }
+        batch = true;
+        queries.push_back(q);
+        first_opt = 3;
+    } else if (string(argv[1]) == "--build-table") {
+        if (argc < 3) {
+            print_usage();
+            return 1;
+        }
+        build_table = true;
+        table_path = "silly.table";
+        first_opt = 3;
+        if (!parse_count(argv[2], n_ll)) return 1;
+    } else if (!parse_count(argv[1], n_ll)) {
+        return 1;
+    }
+
+    for (int i = first_opt; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--quiet") quiet = true;
+        else if (arg == "--targeted") targeted = true;
+        else if (arg == "--core" && i + 1 < argc) {
+            if (!parse_count(argv[++i], core_max)) return 1;
+            if (core_max < 1 || core_max > full_build_max) {
+                std::cerr << "--core needs a count in [1, 2000000].\n";
+                return 1;
+            }
+        } else if (arg == "--stats") stats_format = "text";
+        else if (arg == "--stats=json") stats_format = "json";
+        else if (arg == "--show" && i + 1 < argc) {
+            show = argv[++i];
+        } else if (arg == "--table" && i + 1 < argc) {
+            table_path = argv[++i];
+        } else if (arg == "--extend" && i + 1 < argc && build_table) {
+            extend_path = argv[++i];
+        } else if (arg == "--shards" && i + 1 < argc && build_table) {
+            long long k = 0;
+            if (!parse_count(argv[++i], k) || k < 1) {
+                std::cerr << "--shards needs a positive count.\n";
+                return 1;
+            }
+            shards = (int)std::min<long long>(k, 1024);
+        } else if (arg == "--format" && i + 1 < argc && batch) {
+            const string format = argv[++i];
+            if (format != "tsv" && format != "jsonl") {
+                std::cerr << "--format is tsv or jsonl.\n";
+                return 1;
+            }
+            json = format == "jsonl";
+        } else if (arg == "--top" && i + 1 < argc && !build_table) {
+            long long k = 0;
+            if (!parse_count(argv[++i], k) || k < 1 || k > SyllableSolver::top_max) {
+                std::cerr << "--top needs a count in [1, " << SyllableSolver::top_max << "].\n";
+                return 1;
+            }
+            top = (int)k;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            long long t = 0;
+            if (!parse_count(argv[++i], t) || t < 1) {
+                std::cerr << "--threads needs a positive count.\n";
+                return 1;
+            }
+            threads = (int)std::min<long long>(t, 1024);
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (top > 1 && !table_path.empty()) {
+        std::cerr << "--top needs a fresh build; it does not combine with --table.\n";
+        return 1;
+    }
+
+    if (batch) {
+        bool ok = true;
+        if (queries.empty()) {
+            if (batch_path.empty() || batch_path == "-") {
+                ok = read_queries(std::cin, queries);
+            } else {
+                std::ifstream in(batch_path);
+                if (!in) {
+                    std::cerr << "cannot open " << batch_path << "\n";
+                    return 1;
+                }
+                ok = read_queries(in, queries);
+            }
+        }
+        try {
+            SyllableSolver solver(threads);
+            run_queries(queries, solver, table_path, json, !stats_format.empty(), top);
+            if (!stats_format.empty()) solver.print_stats(std::cerr, stats_format == "json");
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return 1;
+        }
+        return ok ? 0 : 1;
+    }
+
+    if (!build_table && n_ll > max_named) {
+        std::cerr << "Only numbers up to 999,999,999,999 can be named.\n";
+        return 1;
+    }
+    // Past a full build, the dense table stops at the core and the rest is
+    // searched on demand, so memory stays bounded by the core.
+    if (!build_table && n_ll > full_build_max) targeted = true;
+    if (top > 1 && targeted) {
+        std::cerr << "--top needs a full build: numbers up to 2,000,000, without --targeted.\n";
         return 1;
     }
 
-    return 0;
+    // The shards are forked from a single-threaded parent: no solver (and no
+    // pool) is started on this path.
+    if (shards > 1) {
+        if (!extend_path.empty() || !stats_format.empty()) {
+            std::cerr << "--shards does not combine with --extend or --stats.\n";
+            return 1;
+        }
+        if (n_ll > std::min(full_build_max * shards, sharded_build_max)) {
+            std::cerr << "Refusing: table too large for " << shards << " shards; each covers up to 2,000,000"
+                      << " (at most 100,000,000 in all).\n";
+            return 1;
+        }
+        try {
+            if (!build_sharded_table(table_path, (int)n_ll, shards, std::max(1, threads / shards), quiet)) {
+                std::cerr << "sharded build failed\n";
+                return 1;
+            }
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return 1;
+        }
+        if (!quiet) std::cout << "wrote " << table_path << " (0.." << n_ll << ", " << shards << " shards)\n";
+        return 0;
+    }
+
+    try {
+        SyllableSolver solver(threads);
+        SyllableSolver::BuildOptions options;
+        if (!quiet) options.progress = print_progress;
+        options.stats = !stats_format.empty();
+        options.top = top;
+        auto finish = [&](bool ok) {
+            if (!stats_format.empty()) solver.print_stats(std::cout, stats_format == "json");
+            return ok ? 0 : 1;
+        };
+
+        if (!build_table && !table_path.empty()) {
+            solver.load(table_path);
+            if (n_ll <= solver.max_number() || targeted) return print_answer(solver.lookup(n_ll), show) ? 0 : 1;
+            std::cerr << n_ll << " is beyond the table (max " << solver.max_number() << "), computing fresh.\n";
+        }
+
+        if (targeted && !build_table) {
+            solver.build((int)std::min(n_ll, core_max), options);
+            return finish(print_answer(solver.lookup(n_ll), show));
+        }
+
+        if (n_ll > full_build_max) {
+            std::cerr << "Refusing: table too large for a full build in reasonable time.\n";
+            std::cerr << "Try <= 2,000,000, --shards, or remove this guard in the source.\n";
+            return 1;
+        }
+        int n = (int)n_ll;
+
+        if (extend_path.empty()) {
+            solver.build(n, options);
+        } else {
+            // extend drops the old mapping once the new table is in, before save may replace the same file.
+            solver.load(extend_path);
+            if (solver.max_number() > n) {
+                std::cerr << extend_path << " already covers 0.." << solver.max_number() << ".\n";
+                return 1;
+            }
+            solver.extend(n, options);
+        }
+
+        if (!build_table && top > 1) {
+            bool ok = true;
+            int rank = 0;
+            for (const auto& a : solver.lookup_top(n)) {
+                if (!(ok = print_answer(a, show, ++rank))) break;
+            }
+            return finish(ok);
+        }
+        if (!build_table) return finish(print_answer(solver.lookup(n), show));
+        solver.save(table_path);
+        if (!quiet) std::cout << "wrote " << table_path << " (0.." << n << ")\n";
+        return finish(true);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return 1;
+    }
 }
+
+#endif
@@ -0,0 +1,78 @@
+// The silly number namer as a library: one warm table plus the search around it.
+// Library: g++ -O2 -pthread -DSILLY_LIBRARY -c silly.cpp -o silly.o, then include
+// this header and link silly.o (with -pthread). The silly CLI is silly.cpp
+// built without the define, a thin wrapper over SyllableSolver.
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct SyllableAnswer {
+    long long number;
+    std::string name;       // "four million minus one"
+    std::string equation;   // "4000000 - 1"
+    int syllables;
+    int original;           // syllables of the plain spoken number
+    bool searched = false;  // past the table: the best form found, maybe not the shortest
+};
+
+struct SyllableBuildOptions {
+    // Polled between op splits; once it reads true the build stops, returns
+    // false and the previous table stays in place.
+    const std::atomic<bool>* stop = nullptr;
+    // Called on the building thread before each syllable level, with the
+    // level and the smallest number whose best form is still open.
+    std::function<void(int, long long)> progress;
+    // Keep per-split counters for SyllableSolver::print_stats.
+    bool stats = false;
+    // build only: also keep the `top` best distinct forms of every number for
+    // lookup_top, in one search (1..SyllableSolver::top_max, 8 bytes each per number).
+    int top = 1;
+};
+
+// lookup() is const and safe from any number of threads, also while build,
+// extend or load run on another: those fill a new table and swap it in when
+// done, so a query sees either the old table or the new one.
+class SyllableSolver {
+public:
+    using BuildOptions = SyllableBuildOptions;
+
+    // Largest table build and extend make; past a table, lookups search back
+    // over it (fast, but may miss the best form).
+    static constexpr long long build_max = 2000000;
+    // Spelled-out names stop at "billion".
+    static constexpr long long lookup_max = 999999999999LL;
+    static constexpr int top_max = 8;
+
+    explicit SyllableSolver(int threads = 0);   // 0: one per hardware thread
+    ~SyllableSolver();
+    SyllableSolver(const SyllableSolver&) = delete;
+    SyllableSolver& operator=(const SyllableSolver&) = delete;
+
+    // Builds [0, max_number], 0 <= max_number <= build_max.
+    bool build(int max_number, const BuildOptions& options = {});
+    // Grows the current table to max_number, searching only what it could not have seen.
+    bool extend(int max_number, const BuildOptions& options = {});
+    // Serves from a table file (mapped read-only) instead; see save.
+    void load(const std::string& path);
+    // Writes a built table; a loaded one is already a file.
+    void save(const std::string& path) const;
+
+    long long max_number() const;   // -1 before the first build or load
+    // Best form of n, 0 <= n <= lookup_max.
+    SyllableAnswer lookup(long long n) const;
+    // Up to BuildOptions::top best distinct forms of n, best first (the first is
+    // lookup(n)); forms that read the same are listed once. Just lookup(n) past
+    // the table or from a loaded one.
+    std::vector<SyllableAnswer> lookup_top(long long n) const;
+    // Counters from the last build run with BuildOptions::stats.
+    void print_stats(std::ostream& os, bool json) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};